@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// One benchmarked (day, part) on one input, as stored in a baseline file.
+struct BenchRecord {
+  int day;
+  int part;
+  std::uint64_t input_bytes;
+  std::string commit;
+  std::vector<double> samples_ns;
+};
+
+struct MannWhitneyResult {
+  double u;       // U statistic of the current samples
+  double z;       // normal approximation, tie and continuity corrected
+  double p_value; // two-sided
+};
+
+// Returns an empty vector if the file does not exist; throws
+// std::runtime_error if it exists but cannot be parsed.
+std::vector<BenchRecord> load_baseline(const std::string &path);
+
+// Merges `records` into the file at `path`, replacing entries with the same
+// day, part, input size and commit and keeping everything else.
+void save_baseline(const std::string &path,
+                   const std::vector<BenchRecord> &records);
+
+// Latest entry for (day, part, input_bytes), optionally restricted to one
+// commit.
+std::optional<BenchRecord>
+find_baseline(const std::vector<BenchRecord> &baseline, int day, int part,
+              std::uint64_t input_bytes, const std::string &commit = "");
+
+MannWhitneyResult mann_whitney_u(const std::vector<double> &baseline,
+                                 const std::vector<double> &current);
+
+double median(std::vector<double> samples);
@@ -0,0 +1,31 @@
+#ifndef CONSTEXPR_SOLVE_H
+#define CONSTEXPR_SOLVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Answers computed by the compiler from the embedded inputs. Only available
+// in builds configured with AOC_CONSTEXPR_SOLVE.
+long long day01_part1_precomputed(void);
+long long day01_part2_precomputed(void);
+long long day02_part1_precomputed(void);
+long long day02_part2_precomputed(void);
+long long day05_part1_precomputed(void);
+long long day05_part2_precomputed(void);
+long long day13_part1_precomputed(void);
+long long day13_part2_precomputed(void);
+long long day14_part1_precomputed(void);
+long long day14_part2_precomputed(void);
+
+// Nonzero when a solver reading `path` on the calling thread would solve
+// the embedded file the answers above come from, with the default engine.
+// Anything else (a redirected input, --engine reference) is solved at run
+// time.
+int aoc_use_precomputed(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
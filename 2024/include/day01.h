@@ -1,6 +1,8 @@
 #ifndef DAY01_H
 #define DAY01_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -8,6 +10,11 @@ extern "C" {
 void day01_part1(void);
 void day01_part2(void);
 
+// Caps the bytes day 1 spends holding pairs (0, the default, is a quarter
+// of physical memory). Longer inputs are sorted in runs that are spilled to
+// temp files and merged back as streams.
+void day01_set_memory_limit(size_t bytes);
+
 #ifdef __cplusplus
 }
 #endif
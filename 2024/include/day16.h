@@ -1,10 +1,13 @@
 #pragma once
 
+#include "grid.h"
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+namespace day16 {
+
 enum Direction { NORTH, EAST, SOUTH, WEST };
 
 struct State {
@@ -14,40 +17,32 @@ struct State {
   bool operator>(const State &other) const { return cost > other.cost; }
 };
 
-bool operator==(const State &lhs, const State &rhs);
-
-struct PairHash {
-  template <class T1, class T2>
-  std::size_t operator()(const std::pair<T1, T2> &p) const {
-    auto h1 = std::hash<T1>{}(p.first);
-    auto h2 = std::hash<T2>{}(p.second);
-    return h1 ^ (h2 << 1);
-  }
-};
-
-struct StateHash {
-  size_t operator()(const State &s) const {
-    return std::hash<int>()(s.x) ^ (std::hash<int>()(s.y) << 1) ^
-           (std::hash<int>()(static_cast<int>(s.dir)) << 2);
-  }
-};
-
 class MazeSolver {
 public:
-  static std::vector<std::string> read_input(const std::string_view &file_name);
-  static int solve(const std::vector<std::string> &grid);
-  static int count_optimal_paths(const std::vector<std::string> &maze);
-  static void print_maze(const std::vector<std::string> &maze);
-  static void
-  print_optimal_paths(const std::vector<std::string> &maze,
-                      const std::vector<std::vector<bool>> &is_optimal);
+  static Grid<char> read_input(const std::string_view &file_name);
+  static int solve(const Grid<char> &maze);
+  static int count_optimal_paths(const Grid<char> &maze);
+  static void print_maze(const Grid<char> &maze);
+  static void print_optimal_paths(const Grid<char> &maze,
+                                  const Grid<char> &is_optimal);
 
 private:
-  static bool isValid(int x, int y, const std::vector<std::string> &maze);
-  static std::pair<int, int> findStart(const std::vector<std::string> &maze);
-  static std::pair<int, int> findEnd(const std::vector<std::string> &maze);
+  // Walls is a PackedGrid<1> with a bit set per wall, sized for the
+  // 141x141 puzzle inputs or at run time.
+  template <typename Walls>
+  static int lowest_score(const Walls &walls, std::pair<int, int> start,
+                          std::pair<int, int> end);
+  template <typename Walls>
+  static int count_tiles(const Walls &walls, std::pair<int, int> start,
+                         std::pair<int, int> end);
+  template <typename Walls>
+  static bool isValid(int x, int y, const Walls &walls);
+  static std::pair<int, int> findStart(const Grid<char> &maze);
+  static std::pair<int, int> findEnd(const Grid<char> &maze);
 };
 
+} // namespace day16
+
 void day16_part1();
 void day16_part2();
 
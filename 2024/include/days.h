@@ -0,0 +1,14 @@
+#pragma once
+
+#include <span>
+
+struct DayEntry {
+  int day;
+  void (*part1)();
+  void (*part2)();
+  const char *input; // relative to the build directory, like the solvers
+  bool parallel;     // honours omp_set_num_threads()
+};
+
+std::span<const DayEntry> all_days();
+const DayEntry *find_day(int day);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "days.h"
+#include <vector>
+
+// Days that have both a reference and a fast engine and an input generator
+// for differential checking.
+bool has_diff_generator(int day);
+
+// Runs every day in `days` under both engines on `cases` generated inputs
+// and compares what they print. Mismatching inputs are kept on disk and
+// reported; returns the number of them.
+int run_diff(const std::vector<const DayEntry *> &days, int cases);
@@ -0,0 +1,37 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Which implementation a solver with more than one should use. The
+// reference engines are the original straightforward solvers and are kept
+// as the oracle the fast ones are checked against (`aoc2024 --diff`).
+enum {
+  AOC_ENGINE_FAST = 0,
+  AOC_ENGINE_REFERENCE = 1,
+};
+
+#ifdef __cplusplus
+#define AOC_THREAD_LOCAL thread_local
+#else
+#define AOC_THREAD_LOCAL _Thread_local
+#endif
+
+// Per thread, like the input redirect, so drivers running days side by side
+// on different threads can pick engines independently.
+extern AOC_THREAD_LOCAL int aoc_engine;
+
+void aoc_set_engine(int engine);
+
+// "fast" or "reference" to the enum value, -1 for anything else.
+int aoc_parse_engine(const char *name);
+
+const char *aoc_engine_name(int engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Minimal lazy generator for pipelines of coroutine stages (std::generator
+// is not available before GCC 14). Values are handed out by reference to
+// the yielded object, which lives until the consumer advances, so stages
+// can yield views into their own buffers without copying.
+template <typename T> class Generator {
+public:
+  using value_type = std::remove_cvref_t<T>;
+  using pointer = std::add_pointer_t<value_type>;
+
+  struct promise_type {
+    pointer current = nullptr;
+    std::exception_ptr exception;
+
+    Generator get_return_object() {
+      return Generator(Handle::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    std::suspend_always yield_value(value_type &value) noexcept {
+      current = std::addressof(value);
+      return {};
+    }
+    std::suspend_always yield_value(value_type &&value) noexcept {
+      current = std::addressof(value);
+      return {};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() { exception = std::current_exception(); }
+    void await_transform() = delete;
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Generator::value_type;
+
+    iterator() = default;
+    explicit iterator(Handle handle) : handle(handle) {}
+
+    iterator &operator++() {
+      advance(handle);
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    value_type &operator*() const { return *handle.promise().current; }
+    bool operator==(std::default_sentinel_t) const {
+      return !handle || handle.done();
+    }
+
+  private:
+    Handle handle;
+  };
+
+  explicit Generator(Handle handle) : handle(handle) {}
+  Generator(Generator &&other) noexcept
+      : handle(std::exchange(other.handle, nullptr)) {}
+  Generator &operator=(Generator &&other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+  }
+  Generator(const Generator &) = delete;
+  Generator &operator=(const Generator &) = delete;
+  ~Generator() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  iterator begin() {
+    advance(handle);
+    return iterator(handle);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  static void advance(Handle handle) {
+    handle.resume();
+    if (handle.done() && handle.promise().exception) {
+      std::rethrow_exception(handle.promise().exception);
+    }
+  }
+
+  Handle handle;
+};
@@ -0,0 +1,379 @@
+#pragma once
+
+#include "huge_pages.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// How Grid<T> orders its cells in memory. Row-major keeps vertical
+// neighbours a full row apart, which stops fitting in cache once a grid
+// outgrows the LLC. Tiled and Morton both store 64x64 tiles one after
+// another, row-major inside a tile or along a Z-order (Morton) curve, so
+// both axes stay local and each axis is padded by less than a tile.
+enum class GridLayout { RowMajor, Tiled, Morton };
+
+// Layout dispatch_grid_shape hands to the runtime-sized path. Defaults to
+// RowMajor; the drivers set it from --grid-layout.
+void set_grid_layout(GridLayout layout);
+GridLayout grid_layout();
+
+// "row", "tiled" or "morton".
+std::optional<GridLayout> parse_grid_layout(std::string_view name);
+const char *grid_layout_name(GridLayout layout);
+
+// Whether solvers that can keep a grid sparsely do so. Auto decides per
+// grid from how many cells the solver expects to set; the drivers set it
+// from --grid-storage.
+enum class GridStorage { Auto, Dense, Sparse };
+
+void set_grid_storage(GridStorage storage);
+GridStorage grid_storage();
+
+// "auto", "dense" or "sparse".
+std::optional<GridStorage> parse_grid_storage(std::string_view name);
+const char *grid_storage_name(GridStorage storage);
+
+// (row, col) steps north, east, south and west, the order for_each_neighbor
+// visits them in and the order of day 16's Direction.
+inline constexpr std::array<std::pair<int, int>, 4> GRID_STEPS = {
+    {{-1, 0}, {0, 1}, {1, 0}, {0, -1}}};
+
+// Dense 2D grid addressed by (row, col) whatever the layout. The layout is
+// a template argument, so at() compiles to one index formula; solvers get
+// the one picked by --grid-layout from dispatch_grid_shape. At scale these
+// are the largest buffers in the solvers, so they are backed by huge pages
+// when the harness enables them. T should not be bool: at() returns T&.
+template <typename T, GridLayout Layout = GridLayout::RowMajor> class Grid {
+public:
+  static constexpr int TILE_SHIFT = 6;
+  static constexpr int TILE_MASK = (1 << TILE_SHIFT) - 1;
+
+  // Same kind of grid holding U, for a solver's per-cell bookkeeping.
+  template <typename U> using rebind = Grid<U, Layout>;
+
+  Grid() = default;
+
+  Grid(int rows, int cols, const T &fill = T())
+      : row_count(rows), col_count(cols),
+        tile_cols((static_cast<std::size_t>(cols) + TILE_MASK) >> TILE_SHIFT) {
+    std::size_t cells_needed = static_cast<std::size_t>(rows) * cols;
+    if constexpr (Layout != GridLayout::RowMajor) {
+      const std::size_t tile_rows =
+          (static_cast<std::size_t>(rows) + TILE_MASK) >> TILE_SHIFT;
+      cells_needed = tile_rows * tile_cols << (2 * TILE_SHIFT);
+    }
+    cells.assign(cells_needed, fill);
+  }
+
+  int rows() const { return row_count; }
+  int cols() const { return col_count; }
+  static constexpr GridLayout layout() { return Layout; }
+
+  bool in_bounds(int r, int c) const {
+    return r >= 0 && r < row_count && c >= 0 && c < col_count;
+  }
+
+  T &at(int r, int c) { return cells[index(r, c)]; }
+  const T &at(int r, int c) const { return cells[index(r, c)]; }
+
+  // Calls f(r, c) for each in-bounds cell north, east, south and west of
+  // (row, col), in that order.
+  template <typename F> void for_each_neighbor(int row, int col, F &&f) const {
+    if (row > 0) {
+      f(row - 1, col);
+    }
+    if (col + 1 < col_count) {
+      f(row, col + 1);
+    }
+    if (row + 1 < row_count) {
+      f(row + 1, col);
+    }
+    if (col > 0) {
+      f(row, col - 1);
+    }
+  }
+
+  std::size_t index(int r, int c) const {
+    const auto row = static_cast<std::size_t>(r);
+    const auto col = static_cast<std::size_t>(c);
+    if constexpr (Layout == GridLayout::RowMajor) {
+      return row * col_count + col;
+    } else {
+      const std::size_t tile =
+          ((row >> TILE_SHIFT) * tile_cols + (col >> TILE_SHIFT))
+          << (2 * TILE_SHIFT);
+      if constexpr (Layout == GridLayout::Tiled) {
+        return tile | (row & TILE_MASK) << TILE_SHIFT | (col & TILE_MASK);
+      } else {
+        return tile | spread_bits(col & TILE_MASK) |
+               spread_bits(row & TILE_MASK) << 1;
+      }
+    }
+  }
+
+private:
+  // Moves bit i of a 6-bit v to bit 2i.
+  static constexpr std::size_t spread_bits(std::size_t v) {
+    v = (v | v << 4) & 0x30F;
+    v = (v | v << 2) & 0x333;
+    v = (v | v << 1) & 0x555;
+    return v;
+  }
+
+  int row_count = 0;
+  int col_count = 0;
+  std::size_t tile_cols = 0;
+  std::vector<T, HugePageAllocator<T>> cells;
+};
+
+// Row-major grid whose dimensions are template arguments, for inputs whose
+// size is known ahead of time: every index is a multiply by a constant, so
+// the neighbour math folds and bounds checks against the edges compare with
+// immediates. Same interface as Grid<T>; the constructor's dimensions are
+// only there to match it and must equal Rows and Cols.
+template <typename T, int Rows, int Cols> class FixedGrid {
+public:
+  template <typename U> using rebind = FixedGrid<U, Rows, Cols>;
+
+  explicit FixedGrid(int = Rows, int = Cols, const T &fill = T())
+      : cells(static_cast<std::size_t>(Rows) * Cols, fill) {}
+
+  static constexpr int rows() { return Rows; }
+  static constexpr int cols() { return Cols; }
+  static constexpr GridLayout layout() { return GridLayout::RowMajor; }
+
+  static constexpr bool in_bounds(int r, int c) {
+    return r >= 0 && r < Rows && c >= 0 && c < Cols;
+  }
+
+  T &at(int r, int c) { return cells[index(r, c)]; }
+  const T &at(int r, int c) const { return cells[index(r, c)]; }
+
+  template <typename F> void for_each_neighbor(int row, int col, F &&f) const {
+    if (row > 0) {
+      f(row - 1, col);
+    }
+    if (col + 1 < Cols) {
+      f(row, col + 1);
+    }
+    if (row + 1 < Rows) {
+      f(row + 1, col);
+    }
+    if (col > 0) {
+      f(row, col - 1);
+    }
+  }
+
+  static constexpr std::size_t index(int r, int c) {
+    return static_cast<std::size_t>(r) * Cols + c;
+  }
+
+private:
+  std::vector<T, HugePageAllocator<T>> cells;
+};
+
+// Grid that only stores the cells written through it; every other cell
+// reads as the fill value. For maps where a few cells out of millions are
+// ever set, it costs memory per set cell rather than per cell. Besides the
+// hash of set cells it keeps one bit per 8x8 block saying whether any cell
+// in the block is set, so reads of empty regions (most of them) never hash.
+//
+// Same interface as Grid<T>, except that at() on a non-const grid stores
+// the cell even when the caller only reads it: read through a const
+// reference where that matters.
+template <typename T> class SparseGrid {
+public:
+  static constexpr int BLOCK_SHIFT = 3;
+
+  template <typename U> using rebind = SparseGrid<U>;
+
+  SparseGrid() = default;
+
+  SparseGrid(int rows, int cols, const T &fill = T())
+      : row_count(rows), col_count(cols), fill(fill),
+        block_cols(block_count(cols)),
+        blocks((block_count(rows) * block_cols + 63) / 64) {}
+
+  int rows() const { return row_count; }
+  int cols() const { return col_count; }
+  static constexpr GridLayout layout() { return GridLayout::RowMajor; }
+
+  bool in_bounds(int r, int c) const {
+    return r >= 0 && r < row_count && c >= 0 && c < col_count;
+  }
+
+  T &at(int r, int c) {
+    const auto [cell, inserted] = cells.try_emplace(index(r, c), fill);
+    if (inserted) {
+      const std::size_t block = block_index(r, c);
+      blocks[block / 64] |= std::uint64_t{1} << block % 64;
+    }
+    return cell->second;
+  }
+
+  const T &at(int r, int c) const {
+    const std::size_t block = block_index(r, c);
+    if (!(blocks[block / 64] >> block % 64 & 1)) {
+      return fill;
+    }
+    const auto cell = cells.find(index(r, c));
+    return cell == cells.end() ? fill : cell->second;
+  }
+
+  template <typename F> void for_each_neighbor(int row, int col, F &&f) const {
+    if (row > 0) {
+      f(row - 1, col);
+    }
+    if (col + 1 < col_count) {
+      f(row, col + 1);
+    }
+    if (row + 1 < row_count) {
+      f(row + 1, col);
+    }
+    if (col > 0) {
+      f(row, col - 1);
+    }
+  }
+
+  std::size_t index(int r, int c) const {
+    return static_cast<std::size_t>(r) * col_count + c;
+  }
+
+  // Cells stored so far.
+  std::size_t stored() const { return cells.size(); }
+
+private:
+  static std::size_t block_count(int cells) {
+    return (static_cast<std::size_t>(cells) + (1 << BLOCK_SHIFT) - 1) >>
+           BLOCK_SHIFT;
+  }
+
+  std::size_t block_index(int r, int c) const {
+    return (static_cast<std::size_t>(r) >> BLOCK_SHIFT) * block_cols +
+           (static_cast<std::size_t>(c) >> BLOCK_SHIFT);
+  }
+
+  int row_count = 0;
+  int col_count = 0;
+  T fill = T();
+  std::size_t block_cols = 0;
+  std::vector<std::uint64_t> blocks;
+  std::unordered_map<std::size_t, T> cells;
+};
+
+// A grid size the solvers specialize for; GridShape<0, 0> (AnyShape) means
+// the size is only known at run time, and SparseShape that it is only known
+// at run time and the grid should be a SparseGrid.
+// A runtime-sized shape also carries the layout its Grids use.
+template <int Rows, int Cols, GridLayout Layout = GridLayout::RowMajor>
+struct GridShape {
+  static constexpr int rows = Rows;
+  static constexpr int cols = Cols;
+  static constexpr GridLayout layout = Layout;
+};
+using AnyShape = GridShape<0, 0>;
+using SparseShape = GridShape<-1, -1>;
+
+template <typename T, typename Shape>
+using ShapedGrid = std::conditional_t<
+    Shape::rows == 0, Grid<T, Shape::layout>,
+    std::conditional_t<Shape::rows < 0, SparseGrid<T>,
+                       FixedGrid<T, Shape::rows, Shape::cols>>>;
+
+// Calls f(Shape{}) for the first of Shapes that is rows x cols, and
+// f(AnyShape{}) when none is. For size-specialized code that keeps no grid;
+// solvers that do use dispatch_grid_shape.
+template <typename F> decltype(auto) dispatch_shape(int, int, F &&f) {
+  return f(AnyShape{});
+}
+
+template <typename Shape, typename... Rest, typename F>
+decltype(auto) dispatch_shape(int rows, int cols, F &&f) {
+  if (rows == Shape::rows && cols == Shape::cols) {
+    return f(Shape{});
+  }
+  return dispatch_shape<Rest...>(rows, cols, std::forward<F>(f));
+}
+
+// dispatch_shape for solvers working on ShapedGrids. Fixed grids are always
+// row-major, so a non-default --grid-layout takes the runtime-sized path
+// with that layout; this is the only place the layout is looked up.
+template <typename... Shapes, typename F>
+decltype(auto) dispatch_grid_shape(int rows, int cols, F &&f) {
+  switch (grid_layout()) {
+  case GridLayout::Tiled:
+    return f(GridShape<0, 0, GridLayout::Tiled>{});
+  case GridLayout::Morton:
+    return f(GridShape<0, 0, GridLayout::Morton>{});
+  case GridLayout::RowMajor:
+    break;
+  }
+  return dispatch_shape<Shapes...>(rows, cols, std::forward<F>(f));
+}
+
+// A grid with fewer than one cell in this many set is kept sparsely when
+// the storage is Auto. A set cell costs a SparseGrid around 32 bytes.
+inline constexpr std::size_t SPARSE_DENSITY_RATIO = 64;
+
+inline bool use_sparse_grid(int rows, int cols, std::size_t expected_set) {
+  switch (grid_storage()) {
+  case GridStorage::Dense:
+    return false;
+  case GridStorage::Sparse:
+    return true;
+  case GridStorage::Auto:
+    break;
+  }
+  return expected_set * SPARSE_DENSITY_RATIO <
+         static_cast<std::size_t>(rows) * cols;
+}
+
+// dispatch_grid_shape that first picks SparseShape when a solver expects
+// to set only `expected_set` of the rows x cols cells.
+template <typename... Shapes, typename F>
+decltype(auto) dispatch_grid_density(int rows, int cols,
+                                     std::size_t expected_set, F &&f) {
+  if (use_sparse_grid(rows, cols, expected_set)) {
+    return f(SparseShape{});
+  }
+  return dispatch_grid_shape<Shapes...>(rows, cols, std::forward<F>(f));
+}
+
+// Copies text lines into the grid type Shape selects (row-major by
+// default); shorter lines are padded with `fill`.
+template <typename Shape = AnyShape>
+ShapedGrid<char, Shape> make_char_grid(const std::vector<std::string> &lines,
+                                       char fill = '.') {
+  std::size_t cols = 0;
+  for (const auto &line : lines) {
+    cols = std::max(cols, line.size());
+  }
+  ShapedGrid<char, Shape> grid(static_cast<int>(lines.size()),
+                               static_cast<int>(cols), fill);
+  for (int r = 0; r < grid.rows(); r++) {
+    for (int c = 0; c < static_cast<int>(lines[r].size()); c++) {
+      grid.at(r, c) = lines[r][c];
+    }
+  }
+  return grid;
+}
+
+// Copies `grid` into the grid type Shape selects.
+template <typename Shape, typename T>
+ShapedGrid<T, Shape> reshape(const Grid<T> &grid) {
+  ShapedGrid<T, Shape> out(grid.rows(), grid.cols());
+  for (int r = 0; r < grid.rows(); r++) {
+    for (int c = 0; c < grid.cols(); c++) {
+      out.at(r, c) = grid.at(r, c);
+    }
+  }
+  return out;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Large solver buffers (>= HUGE_PAGE_MIN_BYTES) are mmap'ed in 2 MiB
+// multiples. When huge pages are enabled the mapping is first tried with
+// MAP_HUGETLB and otherwise madvise'd for transparent huge pages; when they
+// are disabled it is a plain anonymous mapping, so toggling the switch
+// between allocation and release is safe.
+inline constexpr std::size_t HUGE_PAGE_SIZE = 2u << 20;
+inline constexpr std::size_t HUGE_PAGE_MIN_BYTES = HUGE_PAGE_SIZE / 2;
+
+void set_huge_pages(bool enabled);
+bool huge_pages_enabled();
+
+void *huge_alloc(std::size_t bytes);
+void huge_free(void *ptr, std::size_t bytes);
+
+template <typename T> struct HugePageAllocator {
+  using value_type = T;
+
+  HugePageAllocator() noexcept = default;
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+    if (bytes < HUGE_PAGE_MIN_BYTES) {
+      return static_cast<T *>(::operator new(bytes));
+    }
+    return static_cast<T *>(huge_alloc(bytes));
+  }
+
+  void deallocate(T *ptr, std::size_t n) noexcept {
+    const std::size_t bytes = n * sizeof(T);
+    if (bytes < HUGE_PAGE_MIN_BYTES) {
+      ::operator delete(ptr);
+    } else {
+      huge_free(ptr, bytes);
+    }
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U> &) const noexcept {
+    return true;
+  }
+};
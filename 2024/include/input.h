@@ -0,0 +1,59 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Opens a puzzle input for reading. Builds configured with AOC_EMBED_INPUTS
+// serve the copy compiled into the binary, and inputs queued with
+// prefetch_inputs() are served from memory once loaded, both through
+// fmemopen(); anything else is fopen(path, "r").
+FILE *aoc_open_input(const char *path);
+
+// Makes aoc_open_input()/InputStream on the calling thread read `path`
+// instead of the path the solver asked for, so a day can run on another
+// input file. NULL restores the solver's own input.
+void aoc_redirect_input(const char *path);
+
+// The path an open request for `path` on the calling thread reads: the
+// redirect target if one is set, otherwise `path` itself.
+const char *aoc_input_path(const char *path);
+
+// Returns the embedded bytes for `path` and stores their length in `size`,
+// or returns NULL if `path` was not embedded.
+const char *aoc_embedded_input(const char *path, size_t *size);
+
+#ifdef __cplusplus
+}
+
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string_view>
+
+// std::ifstream replacement for the C++ solvers, backed by the same sources
+// as aoc_open_input().
+class InputStream : public std::istream {
+public:
+  explicit InputStream(std::string_view path);
+
+  bool is_open() const { return open; }
+  void close();
+
+private:
+  class MemoryBuf : public std::streambuf {
+  public:
+    void assign(const char *data, size_t size);
+  };
+
+  MemoryBuf memory;
+  std::filebuf file;
+  bool open = false;
+};
+#endif
+
+#endif
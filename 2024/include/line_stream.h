@@ -0,0 +1,21 @@
+#pragma once
+
+#include "generator.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+inline constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+// First pipeline stage: reads an input through aoc_open_input() in
+// fixed-size chunks. Each view stays valid until the consumer advances.
+// While the consumer works on one chunk the kernel is asked to read the
+// next one ahead (posix_fadvise WILLNEED), so I/O overlaps with parsing.
+// Yields nothing if the input cannot be opened.
+Generator<std::string_view>
+read_chunks(std::string path, std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+// Second stage: reassembles chunks into lines without the trailing '\n'.
+// Only a line split across two chunks is copied, so memory stays bounded
+// by the chunk size plus the longest line.
+Generator<std::string_view> split_lines(Generator<std::string_view> chunks);
@@ -0,0 +1,51 @@
+#ifndef LOG_H
+#define LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Diagnostic verbosity. Answers are always printed; these levels only gate
+// the solvers' debugging output, which goes to stderr.
+enum {
+  AOC_LOG_QUIET = 0,
+  AOC_LOG_DEBUG = 1, // per-record detail (e.g. one line per machine)
+  AOC_LOG_TRACE = 2, // per-line and whole-grid dumps
+};
+
+// Highest level compiled in. Statements above it are removed by the
+// compiler, so default builds pay nothing for diagnostics in hot loops.
+#ifndef AOC_MAX_VERBOSITY
+#define AOC_MAX_VERBOSITY AOC_LOG_QUIET
+#endif
+
+extern int aoc_verbosity;
+
+// Sets the runtime level; it is clamped to AOC_MAX_VERBOSITY. Enabling any
+// level gives stderr a full buffer so dumps are not written a line at a
+// time.
+void aoc_set_verbosity(int level);
+
+void aoc_log_printf(const char *format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 1, 2)))
+#endif
+    ;
+
+#define AOC_LOG_ENABLED(level)                                                 \
+  ((level) <= AOC_MAX_VERBOSITY && (level) <= aoc_verbosity)
+
+#define AOC_LOG(level, ...)                                                    \
+  do {                                                                         \
+    if (AOC_LOG_ENABLED(level))                                                \
+      aoc_log_printf(__VA_ARGS__);                                             \
+  } while (0)
+
+#define AOC_DEBUG(...) AOC_LOG(AOC_LOG_DEBUG, __VA_ARGS__)
+#define AOC_TRACE(...) AOC_LOG(AOC_LOG_TRACE, __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
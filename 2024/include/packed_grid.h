@@ -0,0 +1,173 @@
+#pragma once
+
+#include "grid.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Grid of Bits-bit cells (1, 2 or 4) packed into 64-bit words, for cells
+// from a tiny alphabet: a wall bit, one of four warehouse tiles, a height
+// 0-9. A 20k x 20k map of walls takes 50 MB instead of the 400 MB it does
+// as chars. Rows start on a word boundary, so a row unpacks word by word.
+//
+// Shape is as for ShapedGrid: with fixed dimensions the row stride is a
+// constant. Bookkeeping grids a solver keeps next to it (rebind) are plain
+// ShapedGrids, since per-cell distances and counts do not pack. Like
+// std::vector<bool>, at() on a non-const grid returns an assignable proxy
+// and on a const grid the cell's value.
+template <int Bits, typename Shape = AnyShape> class PackedGrid {
+  static_assert(Bits == 1 || Bits == 2 || Bits == 4,
+                "packed cells must tile a byte");
+  static_assert(Shape::rows >= 0, "a packed grid is always dense");
+
+public:
+  static constexpr int CELLS_PER_WORD = 64 / Bits;
+  static constexpr std::uint64_t CELL_MASK = (std::uint64_t{1} << Bits) - 1;
+
+  template <typename U> using rebind = ShapedGrid<U, Shape>;
+
+  class Cell {
+  public:
+    Cell(const Cell &) = default;
+
+    operator unsigned() const {
+      return static_cast<unsigned>(word >> shift & CELL_MASK);
+    }
+    Cell &operator=(unsigned value) {
+      word = (word & ~(CELL_MASK << shift)) |
+             (static_cast<std::uint64_t>(value) & CELL_MASK) << shift;
+      return *this;
+    }
+    Cell &operator=(const Cell &other) {
+      return *this = static_cast<unsigned>(other);
+    }
+
+  private:
+    friend class PackedGrid;
+    Cell(std::uint64_t &word, int shift) : word(word), shift(shift) {}
+
+    std::uint64_t &word;
+    int shift;
+  };
+
+  PackedGrid() = default;
+
+  PackedGrid(int rows, int cols, unsigned fill = 0)
+      : row_count(rows), col_count(cols),
+        words(static_cast<std::size_t>(rows) * stride(cols),
+              repeat(fill)) {}
+
+  int rows() const { return Shape::rows ? Shape::rows : row_count; }
+  int cols() const { return Shape::cols ? Shape::cols : col_count; }
+  static constexpr GridLayout layout() { return GridLayout::RowMajor; }
+
+  bool in_bounds(int r, int c) const {
+    return r >= 0 && r < rows() && c >= 0 && c < cols();
+  }
+
+  Cell at(int r, int c) { return Cell(words[word_index(r, c)], shift(c)); }
+  unsigned at(int r, int c) const {
+    return static_cast<unsigned>(words[word_index(r, c)] >> shift(c) &
+                                 CELL_MASK);
+  }
+
+  template <typename F> void for_each_neighbor(int row, int col, F &&f) const {
+    if (row > 0) {
+      f(row - 1, col);
+    }
+    if (col + 1 < cols()) {
+      f(row, col + 1);
+    }
+    if (row + 1 < rows()) {
+      f(row + 1, col);
+    }
+    if (col > 0) {
+      f(row, col - 1);
+    }
+  }
+
+  // Writes row r's cells to out[0, cols()), one per byte. Eight cells are
+  // spread to the eight bytes of a word with shifts and masks, so a row
+  // costs a few operations per eight cells rather than per cell.
+  void unpack_row(int r, std::uint8_t *out) const {
+    const std::uint64_t *row =
+        words.data() + static_cast<std::size_t>(r) * stride(cols());
+    const int n = cols();
+    int c = 0;
+    for (; c + 8 <= n; c += 8) {
+      const std::uint64_t bytes = spread(
+          row[c / CELLS_PER_WORD] >> shift(c) & GROUP_MASK);
+      store(out + c, bytes);
+    }
+    for (; c < n; c++) {
+      out[c] = static_cast<std::uint8_t>(
+          row[c / CELLS_PER_WORD] >> shift(c) & CELL_MASK);
+    }
+  }
+
+private:
+  // Eight cells' worth of bits.
+  static constexpr std::uint64_t GROUP_MASK =
+      (std::uint64_t{1} << (8 * Bits)) - 1;
+
+  static constexpr std::size_t stride(int cols) {
+    return (static_cast<std::size_t>(cols) + CELLS_PER_WORD - 1) /
+           CELLS_PER_WORD;
+  }
+
+  static constexpr int shift(int c) { return c % CELLS_PER_WORD * Bits; }
+
+  std::size_t word_index(int r, int c) const {
+    return static_cast<std::size_t>(r) * stride(cols()) + c / CELLS_PER_WORD;
+  }
+
+  // A word with every cell set to `value`.
+  static constexpr std::uint64_t repeat(unsigned value) {
+    std::uint64_t word = 0;
+    for (int i = 0; i < CELLS_PER_WORD; i++) {
+      word |= (static_cast<std::uint64_t>(value) & CELL_MASK) << (i * Bits);
+    }
+    return word;
+  }
+
+  // Cells i = 0..7 in the low 8 * Bits bits to byte i: halve the distance
+  // between them three times, as in Grid's Morton index.
+  static constexpr std::uint64_t spread(std::uint64_t x) {
+    constexpr std::uint64_t low4 = (std::uint64_t{1} << (4 * Bits)) - 1;
+    constexpr std::uint64_t low2 = (std::uint64_t{1} << (2 * Bits)) - 1;
+    x = (x | x << (32 - 4 * Bits)) & low4 * 0x0000000100000001ull;
+    x = (x | x << (16 - 2 * Bits)) & low2 * 0x0001000100010001ull;
+    x = (x | x << (8 - Bits)) & CELL_MASK * 0x0101010101010101ull;
+    return x;
+  }
+
+  static void store(std::uint8_t *out, std::uint64_t bytes) {
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(out, &bytes, sizeof bytes);
+    } else {
+      for (int i = 0; i < 8; i++) {
+        out[i] = static_cast<std::uint8_t>(bytes >> (8 * i));
+      }
+    }
+  }
+
+  int row_count = 0;
+  int col_count = 0;
+  std::vector<std::uint64_t, HugePageAllocator<std::uint64_t>> words;
+};
+
+// Packs a grid of chars (anything with rows(), cols() and at()) into
+// Bits-bit cells through encode(char) -> cell value.
+template <int Bits, typename Shape = AnyShape, typename Source,
+          typename Encode>
+PackedGrid<Bits, Shape> pack(const Source &grid, Encode &&encode) {
+  PackedGrid<Bits, Shape> out(grid.rows(), grid.cols());
+  for (int r = 0; r < grid.rows(); r++) {
+    for (int c = 0; c < grid.cols(); c++) {
+      out.at(r, c) = encode(grid.at(r, c));
+    }
+  }
+  return out;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads queued inputs into memory in the background so that, by the time a
+// solver opens one through aoc_open_input()/InputStream, its bytes are
+// already resident. Linux builds submit the reads through io_uring; if the
+// ring cannot be created (old kernel, seccomp) or on other platforms a
+// plain reader thread does the same work.
+void prefetch_inputs(const std::vector<std::string> &paths);
+
+// If `path` was queued, waits for it to finish loading and returns its
+// bytes. Returns false for paths that were never queued or failed to load,
+// so callers fall back to opening the file themselves.
+bool prefetched_input(std::string_view path, const char **data,
+                      std::size_t *size);
+
+// Frees a loaded input once nothing reads it anymore.
+void drop_prefetched_input(std::string_view path);
+
+// "io_uring" or "thread", for diagnostics.
+const char *prefetch_backend();
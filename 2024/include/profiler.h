@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+// In-process sampling profiler for environments without perf. A CPU-time
+// timer delivers SIGPROF at `hz`; the handler records the interrupted
+// thread's call stack (libunwind when the build found it, otherwise the
+// frame-pointer chain the build keeps with -fno-omit-frame-pointer) into a
+// preallocated buffer. stop_profiler() symbolizes the samples and writes
+// them as folded stacks ("outer;inner count" per line) for flamegraph
+// tools. Returns false if the timer or output could not be set up.
+bool start_profiler(const std::string &path, int hz = 499);
+
+// Stops sampling and writes the output file. Safe to call when the
+// profiler was never started.
+bool stop_profiler();
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Runs jobs 0..count-1 in `workers` forked processes instead of threads, so
+// days that keep global state (or crash, or call exit()) cannot disturb each
+// other or the driver. Workers claim job indices from a counter in shared
+// anonymous memory, call run(index) with stdout redirected to a private
+// file, and copy what it printed into an mmap'ed result table. The parent
+// writes results to stdout in job order as soon as each one is ready.
+//
+// A worker that dies mid-job fails only that job; a replacement is forked
+// while jobs remain. Returns the number of failed jobs.
+int run_sharded(std::size_t count, int workers,
+                const std::function<void(std::size_t)> &run);
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Vector that keeps its first N elements inline and only touches the heap
+// once it grows past them. For the short-lived per-iteration temporaries in
+// the solvers (a report minus one level, the boxes a push moves), which
+// would otherwise pay an allocation each time round the loop. Supports the
+// subset of std::vector the solvers use; iterators are plain pointers.
+template <typename T, std::size_t N> class small_vector {
+  static_assert(N > 0, "small_vector needs inline capacity");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  small_vector() = default;
+
+  small_vector(std::initializer_list<T> init) {
+    reserve(init.size());
+    for (const T &value : init) {
+      push_back(value);
+    }
+  }
+
+  small_vector(const small_vector &other) {
+    reserve(other.count);
+    for (const T &value : other) {
+      push_back(value);
+    }
+  }
+
+  small_vector(small_vector &&other) noexcept { take(std::move(other)); }
+
+  small_vector &operator=(const small_vector &other) {
+    if (this != &other) {
+      clear();
+      reserve(other.count);
+      for (const T &value : other) {
+        push_back(value);
+      }
+    }
+    return *this;
+  }
+
+  small_vector &operator=(small_vector &&other) noexcept {
+    if (this != &other) {
+      release();
+      take(std::move(other));
+    }
+    return *this;
+  }
+
+  ~small_vector() { release(); }
+
+  size_type size() const { return count; }
+  size_type capacity() const { return cap; }
+  bool empty() const { return count == 0; }
+  // True while the elements still live in the inline buffer.
+  bool is_inline() const { return items == inline_items(); }
+
+  T *data() { return items; }
+  const T *data() const { return items; }
+  iterator begin() { return items; }
+  iterator end() { return items + count; }
+  const_iterator begin() const { return items; }
+  const_iterator end() const { return items + count; }
+
+  T &operator[](size_type i) { return items[i]; }
+  const T &operator[](size_type i) const { return items[i]; }
+  T &back() { return items[count - 1]; }
+  const T &back() const { return items[count - 1]; }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    if (count == cap) {
+      // Build first: args may refer to an element that growing moves.
+      T value(std::forward<Args>(args)...);
+      reserve(cap * 2);
+      return *::new (items + count++) T(std::move(value));
+    }
+    return *::new (items + count++) T(std::forward<Args>(args)...);
+  }
+
+  void pop_back() { items[--count].~T(); }
+
+  void clear() {
+    std::destroy(items, items + count);
+    count = 0;
+  }
+
+  void reserve(size_type wanted) {
+    if (wanted <= cap) {
+      return;
+    }
+    T *grown = static_cast<T *>(::operator new(wanted * sizeof(T)));
+    std::uninitialized_move(items, items + count, grown);
+    std::destroy(items, items + count);
+    if (!is_inline()) {
+      ::operator delete(items);
+    }
+    items = grown;
+    cap = wanted;
+  }
+
+private:
+  T *inline_items() { return reinterpret_cast<T *>(buffer); }
+  const T *inline_items() const {
+    return reinterpret_cast<const T *>(buffer);
+  }
+
+  void release() {
+    clear();
+    if (!is_inline()) {
+      ::operator delete(items);
+    }
+    items = inline_items();
+    cap = N;
+  }
+
+  // Steals a spilled buffer outright; inline elements are moved one by one.
+  // Leaves `other` empty and inline. Expects *this to be empty and inline.
+  void take(small_vector &&other) {
+    if (other.is_inline()) {
+      std::uninitialized_move(other.items, other.items + other.count,
+                              inline_items());
+      count = other.count;
+      other.clear();
+      return;
+    }
+    items = std::exchange(other.items, other.inline_items());
+    cap = std::exchange(other.cap, N);
+    count = std::exchange(other.count, 0);
+  }
+
+  alignas(T) unsigned char buffer[N * sizeof(T)];
+  T *items = inline_items();
+  size_type count = 0;
+  size_type cap = N;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+// Calls run() `iterations` times in this process with its output discarded
+// and prints the time, resident set size and live heap after each call.
+// The first fifth of the iterations is warm-up; after it, heap or RSS that
+// never shrinks and ends higher is reported as growth (a leak, or a cache
+// that is never trimmed), as is latency whose second half is clearly slower
+// than its first. Returns true if neither was seen.
+bool run_soak(const std::string &label, int iterations,
+              const std::function<void()> &run);
@@ -0,0 +1,42 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Named work counters the solvers bump (heap pops, memo hits, VM steps...)
+// so a slow input can be explained and an optimization shown to do less
+// work rather than the same work faster. Names are "dayNN.what".
+//
+// The AOC_STAT_* macros compile to nothing unless the build defines
+// AOC_STATS (cmake -DAOC_STATS=ON), so default builds keep the hot loops
+// unchanged. The registry itself is always built and is per thread: each
+// thread counts, resets and prints its own, so counters bumped inside a
+// parallel region are only seen by the thread that bumped them.
+void aoc_stat_add(const char *name, unsigned long long delta);
+void aoc_stat_max(const char *name, unsigned long long value);
+
+// Clears every counter, e.g. between days.
+void aoc_stats_reset(void);
+
+// Writes "name value" per counter in first-use order.
+void aoc_stats_print(FILE *out);
+
+#ifdef AOC_STATS
+#define AOC_STATS_ENABLED 1
+#define AOC_STAT_ADD(name, delta) aoc_stat_add(name, delta)
+#define AOC_STAT_MAX(name, value) aoc_stat_max(name, value)
+#else
+#define AOC_STATS_ENABLED 0
+#define AOC_STAT_ADD(name, delta) ((void)0)
+#define AOC_STAT_MAX(name, value) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,645 @@
+#include "bench_baseline.h"
+#include "days.h"
+#include "grid.h"
+#include "huge_pages.h"
+#include "input.h"
+#include "prefetch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef AOC_GIT_COMMIT
+#define AOC_GIT_COMMIT "unknown"
+#endif
+
+namespace {
+
+constexpr int EXIT_REGRESSION = 2;
+
+// How --io makes a read cold: evict the file from the page cache first, or
+// read it with O_DIRECT so the cache is bypassed.
+enum class ColdRead { None, Fadvise, Direct };
+
+struct Options {
+  int day = 0;  // 0 runs every day
+  int part = 0; // 0 runs both parts
+  int reps = 10;
+  int warmup = 1;
+  std::string save_path;
+  std::string compare_path;
+  std::string baseline_commit;
+  std::string commit = AOC_GIT_COMMIT;
+  double threshold_pct = 5.0;
+  double alpha = 0.01;
+  std::vector<int> scaling; // thread counts for --scaling
+  std::vector<int> pin_cpus;
+  int spin_warmup_ms = 0;
+  bool huge_pages = false;
+  GridLayout grid_layout = GridLayout::RowMajor;
+  GridStorage grid_storage = GridStorage::Auto;
+  ColdRead io = ColdRead::None; // None: the regular benchmark
+};
+
+void print_usage(const char *prog) {
+  std::cerr
+      << "Usage: " << prog << " [options]\n"
+      << "  --day N             benchmark a single day (default: all)\n"
+      << "  --part 1|2          benchmark a single part (default: both)\n"
+      << "  --reps N            timed repetitions per part (default: 10)\n"
+      << "  --warmup N          untimed repetitions per part (default: 1)\n"
+      << "  --save FILE         store the samples in a baseline file\n"
+      << "  --compare FILE      compare against a baseline file\n"
+      << "  --baseline-commit C compare against entries of commit C only\n"
+      << "  --commit C          commit recorded with --save (default: "
+      << AOC_GIT_COMMIT << ")\n"
+      << "  --threshold PCT     regression threshold on the median "
+         "(default: 5)\n"
+      << "  --alpha A           Mann-Whitney significance level "
+         "(default: 0.01)\n"
+      << "  --scaling 1,2,4,... rerun parallel days at each thread count "
+         "and\n"
+      << "                      report speedup, efficiency and Karp-Flatt\n"
+      << "  --pin 0,2,...       pin the main thread and OpenMP workers to "
+         "these cores\n"
+      << "  --spin-warmup MS    busy-spin MS ms before each part to ramp "
+         "the clock\n"
+      << "  --huge-pages        back large solver buffers with huge pages\n"
+      << "  --grid-layout L     row, tiled or morton order for solver grids\n"
+      << "  --grid-storage S    auto, dense or sparse storage for solver "
+         "grids\n"
+      << "  --io fadvise|direct split each part into reading the input and "
+         "parse+solve,\n"
+      << "                      with the page cache warm and cold (evicted "
+         "with\n"
+      << "                      posix_fadvise, or read with O_DIRECT). "
+         "Solvers parse\n"
+      << "                      as they read, so parse and solve are one "
+         "time, taken\n"
+      << "                      on an input already in memory\n"
+      << "Run from the build directory so the solvers find ../inputs.\n";
+}
+
+std::vector<int> parse_int_list(const std::string &list, int min = 1) {
+  std::vector<int> values;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    const int value = std::atoi(item.c_str());
+    if (item.empty() || value < min) {
+      throw std::invalid_argument("bad list entry '" + item + "'");
+    }
+    values.push_back(value);
+  }
+  return values;
+}
+
+bool parse_options(int argc, char *argv[], Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char * {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument(arg + " needs a value");
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--day") {
+      opts.day = std::atoi(value());
+    } else if (arg == "--part") {
+      opts.part = std::atoi(value());
+    } else if (arg == "--reps") {
+      opts.reps = std::atoi(value());
+    } else if (arg == "--warmup") {
+      opts.warmup = std::atoi(value());
+    } else if (arg == "--save") {
+      opts.save_path = value();
+    } else if (arg == "--compare") {
+      opts.compare_path = value();
+    } else if (arg == "--baseline-commit") {
+      opts.baseline_commit = value();
+    } else if (arg == "--commit") {
+      opts.commit = value();
+    } else if (arg == "--threshold") {
+      opts.threshold_pct = std::atof(value());
+    } else if (arg == "--alpha") {
+      opts.alpha = std::atof(value());
+    } else if (arg == "--scaling") {
+      opts.scaling = parse_int_list(value());
+    } else if (arg == "--pin") {
+      opts.pin_cpus = parse_int_list(value(), 0);
+    } else if (arg == "--spin-warmup") {
+      opts.spin_warmup_ms = std::atoi(value());
+    } else if (arg == "--huge-pages") {
+      opts.huge_pages = true;
+    } else if (arg == "--grid-layout") {
+      const auto layout = parse_grid_layout(value());
+      if (!layout) {
+        throw std::invalid_argument("unknown grid layout");
+      }
+      opts.grid_layout = *layout;
+    } else if (arg == "--grid-storage") {
+      const auto storage = parse_grid_storage(value());
+      if (!storage) {
+        throw std::invalid_argument("unknown grid storage");
+      }
+      opts.grid_storage = *storage;
+    } else if (arg == "--io") {
+      const std::string mode = value();
+      if (mode == "fadvise") {
+        opts.io = ColdRead::Fadvise;
+      } else if (mode == "direct") {
+        opts.io = ColdRead::Direct;
+      } else {
+        throw std::invalid_argument("unknown --io mode '" + mode + "'");
+      }
+    } else {
+      return false;
+    }
+  }
+  return opts.reps > 0 && opts.warmup >= 0 && opts.part >= 0 &&
+         opts.part <= 2;
+}
+
+// Solvers print their answers; keep that out of the timing and the report.
+class SilencedStdout {
+public:
+  SilencedStdout() {
+    std::cout.flush();
+    std::fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    const int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+    close(devnull);
+  }
+
+  ~SilencedStdout() {
+    std::cout.flush();
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+  }
+
+  SilencedStdout(const SilencedStdout &) = delete;
+  SilencedStdout &operator=(const SilencedStdout &) = delete;
+
+private:
+  int saved;
+};
+
+// Pins the calling thread to the first core and OpenMP worker i to core
+// i % cpus.size(). libgomp keeps its pool alive, so the placement sticks
+// until the team grows; call again after omp_set_num_threads().
+bool pin_threads(const std::vector<int> &cpus) {
+  if (cpus.empty()) {
+    return true;
+  }
+
+  bool ok = true;
+#pragma omp parallel reduction(&& : ok)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[omp_get_thread_num() % cpus.size()], &set);
+    ok = sched_setaffinity(0, sizeof(set), &set) == 0;
+  }
+  return ok;
+}
+
+// Keeps a core busy so frequency scaling has ramped up before timing.
+void spin_warmup(int ms) {
+  if (ms <= 0) {
+    return;
+  }
+  const auto until =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  volatile std::uint64_t sink = 0;
+  while (std::chrono::steady_clock::now() < until) {
+    for (int i = 0; i < 1024; i++) {
+      sink = sink * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+  }
+}
+
+std::uint64_t file_size(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+}
+
+// `prepare` runs untimed before every repetition, warm-up included.
+std::vector<double> time_part(void (*solve)(), const Options &opts,
+                              const std::function<void()> &prepare = {}) {
+  std::vector<double> samples;
+  samples.reserve(opts.reps);
+
+  spin_warmup(opts.spin_warmup_ms);
+
+  SilencedStdout silence;
+  for (int i = 0; i < opts.warmup; i++) {
+    if (prepare) {
+      prepare();
+    }
+    solve();
+  }
+  for (int i = 0; i < opts.reps; i++) {
+    if (prepare) {
+      prepare();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    solve();
+    const auto end = std::chrono::steady_clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return samples;
+}
+
+std::string format_ns(double ns) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(ns < 1e6 ? 1 : 2);
+  if (ns < 1e6) {
+    out << ns / 1e3 << " us";
+  } else {
+    out << ns / 1e6 << " ms";
+  }
+  return out.str();
+}
+
+// Strong scaling against the single-thread run. The Karp-Flatt metric
+// e = (1/S - 1/p) / (1 - 1/p) estimates the serial fraction; a value that
+// grows with p points at parallel overhead rather than serial code.
+void run_scaling(const Options &opts,
+                 const std::vector<const DayEntry *> &days) {
+  std::vector<int> threads = opts.scaling;
+  if (std::find(threads.begin(), threads.end(), 1) == threads.end()) {
+    threads.insert(threads.begin(), 1);
+  }
+  std::sort(threads.begin(), threads.end());
+  threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+  const int default_threads = omp_get_max_threads();
+
+  for (const DayEntry *entry : days) {
+    if (!entry->parallel) {
+      if (opts.day) {
+        std::cout << "Day " << entry->day << " is not parallelized\n";
+      }
+      continue;
+    }
+
+    for (int part = 1; part <= 2; part++) {
+      if (opts.part && opts.part != part) {
+        continue;
+      }
+
+      std::cout << "Day " << entry->day << " part " << part << '\n'
+                << std::left << std::setw(9) << "threads" << std::setw(13)
+                << "median" << std::setw(10) << "speedup" << std::setw(12)
+                << "efficiency" << "karp-flatt\n";
+
+      double serial = 0;
+      for (int p : threads) {
+        omp_set_num_threads(p);
+        pin_threads(opts.pin_cpus);
+        const double t =
+            median(time_part(part == 1 ? entry->part1 : entry->part2, opts));
+        if (p == 1) {
+          serial = t;
+        }
+
+        const double speedup = serial / t;
+        std::cout << std::left << std::setw(9) << p << std::setw(13)
+                  << format_ns(t) << std::fixed << std::setprecision(2)
+                  << std::setw(10) << speedup << std::setw(12)
+                  << speedup / p;
+        if (p > 1) {
+          std::cout << std::setprecision(3)
+                    << (1 / speedup - 1.0 / p) / (1 - 1.0 / p);
+        } else {
+          std::cout << '-';
+        }
+        std::cout << '\n';
+      }
+      std::cout << '\n';
+    }
+  }
+
+  omp_set_num_threads(default_threads);
+}
+
+bool evict_from_page_cache(const char *path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return ok;
+}
+
+// Fraction of the file's pages in the page cache, or -1 if unknown.
+double resident_fraction(const char *path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  const std::uint64_t size = file_size(path);
+  void *map = size ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+                   : MAP_FAILED;
+  close(fd);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+  const std::size_t page = sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> pages((size + page - 1) / page);
+  double fraction = -1;
+  if (mincore(map, size, pages.data()) == 0) {
+    const auto resident =
+        std::count_if(pages.begin(), pages.end(),
+                      [](unsigned char p) { return p & 1; });
+    fraction = static_cast<double>(resident) / pages.size();
+  }
+  munmap(map, size);
+  return fraction;
+}
+
+// Reads the whole file in 1 MiB blocks, the way a solver would at best.
+// Returns false if it cannot be read (O_DIRECT is refused by some
+// filesystems, tmpfs among them).
+bool read_whole_file(const char *path, bool direct) {
+  constexpr std::size_t BLOCK = 1 << 20;
+  const int fd = open(path, O_RDONLY | (direct ? O_DIRECT : 0));
+  if (fd < 0) {
+    return false;
+  }
+  // O_DIRECT needs a buffer aligned to the logical block size.
+  void *buffer = std::aligned_alloc(4096, BLOCK);
+  if (buffer == nullptr) {
+    close(fd);
+    return false;
+  }
+  ssize_t n;
+  while ((n = read(fd, buffer, BLOCK)) > 0) {
+  }
+  std::free(buffer);
+  close(fd);
+  return n == 0;
+}
+
+std::vector<double> time_read(const char *path, const Options &opts,
+                              bool cold) {
+  const bool direct = cold && opts.io == ColdRead::Direct;
+  std::vector<double> samples;
+  for (int i = 0; i < opts.reps; i++) {
+    if (cold && !direct) {
+      evict_from_page_cache(path);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    if (!read_whole_file(path, direct)) {
+      return {};
+    }
+    const auto end = std::chrono::steady_clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return samples;
+}
+
+std::string format_median(const std::vector<double> &samples) {
+  return samples.empty() ? "-" : format_ns(median(samples));
+}
+
+// Solvers parse while they read, so a part cannot be cut at the parse/solve
+// boundary from outside. Instead --io times the input's bytes coming off
+// disk on their own ("read") and the part run on an input already in
+// memory, served from a prefetch buffer ("parse+solve"), next to the part
+// run normally with the cache warm and cold. "io share" is how much of the
+// cold run the in-memory run does not account for.
+int run_io(const Options &opts, const std::vector<const DayEntry *> &days) {
+  std::cout << std::left << std::setw(5) << "day" << std::setw(6) << "part"
+            << std::setw(10) << "bytes" << std::setw(12) << "read warm"
+            << std::setw(12) << "read cold" << std::setw(13) << "parse+solve"
+            << std::setw(12) << "total warm" << std::setw(12) << "total cold"
+            << "io share\n";
+
+  bool checked_eviction = false;
+  for (const DayEntry *entry : days) {
+    const char *path = entry->input;
+    size_t embedded_size;
+    if (aoc_embedded_input(path, &embedded_size)) {
+      std::cout << "Day " << entry->day
+                << ": input is embedded in the binary, no I/O to measure\n";
+      continue;
+    }
+
+    // Warm the cache, then check that eviction works here at all; some
+    // container filesystems ignore DONTNEED.
+    read_whole_file(path, false);
+    if (!checked_eviction && opts.io == ColdRead::Fadvise) {
+      checked_eviction = true;
+      evict_from_page_cache(path);
+      if (resident_fraction(path) > 0.5) {
+        std::cerr << "posix_fadvise(DONTNEED) left " << path
+                  << " cached; cold numbers will look warm. Try --io "
+                     "direct.\n";
+      }
+    }
+
+    const auto read_warm = time_read(path, opts, false);
+    const auto read_cold = time_read(path, opts, true);
+    if (read_cold.empty() && opts.io == ColdRead::Direct) {
+      std::cerr << path << ": O_DIRECT read failed; no cold read times\n";
+    }
+
+    for (int part = 1; part <= 2; part++) {
+      if (opts.part && opts.part != part) {
+        continue;
+      }
+      void (*solve)() = part == 1 ? entry->part1 : entry->part2;
+
+      prefetch_inputs({path});
+      const char *data;
+      std::size_t size;
+      prefetched_input(path, &data, &size); // wait for it to load
+      const auto in_memory = time_part(solve, opts);
+      drop_prefetched_input(path);
+
+      read_whole_file(path, false);
+      const auto total_warm = time_part(solve, opts);
+      const auto total_cold =
+          time_part(solve, opts, [path] { evict_from_page_cache(path); });
+
+      const double memory_ns = median(in_memory);
+      const double cold_ns = median(total_cold);
+      std::ostringstream share;
+      if (cold_ns > 0) {
+        share << std::fixed << std::setprecision(1)
+              << std::max(0.0, (cold_ns - memory_ns) / cold_ns * 100) << '%';
+      } else {
+        share << '-';
+      }
+
+      std::cout << std::left << std::setw(5) << entry->day << std::setw(6)
+                << part << std::setw(10) << file_size(path) << std::setw(12)
+                << format_median(read_warm) << std::setw(12)
+                << format_median(read_cold) << std::setw(13)
+                << format_ns(memory_ns) << std::setw(12)
+                << format_ns(median(total_warm)) << std::setw(12)
+                << format_ns(cold_ns) << share.str() << '\n';
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  try {
+    if (!parse_options(argc, argv, opts)) {
+      print_usage(argv[0]);
+      return 1;
+    }
+  } catch (const std::invalid_argument &e) {
+    std::cerr << e.what() << '\n';
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  set_huge_pages(opts.huge_pages);
+  set_grid_layout(opts.grid_layout);
+  set_grid_storage(opts.grid_storage);
+  if (!pin_threads(opts.pin_cpus)) {
+    std::cerr << "sched_setaffinity failed for --pin\n";
+    return 1;
+  }
+
+  std::vector<BenchRecord> baseline;
+  if (!opts.compare_path.empty()) {
+    try {
+      baseline = load_baseline(opts.compare_path);
+    } catch (const std::runtime_error &e) {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+    if (baseline.empty()) {
+      std::cerr << "No baseline entries in " << opts.compare_path << '\n';
+      return 1;
+    }
+  }
+
+  std::vector<const DayEntry *> days;
+  if (opts.day) {
+    const DayEntry *entry = find_day(opts.day);
+    if (!entry) {
+      std::cerr << "Day " << opts.day << " not implemented yet!\n";
+      return 1;
+    }
+    days.push_back(entry);
+  } else {
+    for (const auto &entry : all_days()) {
+      days.push_back(&entry);
+    }
+  }
+
+  if (!opts.scaling.empty()) {
+    run_scaling(opts, days);
+    return 0;
+  }
+  if (opts.io != ColdRead::None) {
+    return run_io(opts, days);
+  }
+
+  std::vector<BenchRecord> results;
+  int regressions = 0;
+
+  std::cout << std::left << std::setw(5) << "day" << std::setw(6) << "part"
+            << std::setw(10) << "bytes" << std::setw(13) << "median";
+  if (!baseline.empty()) {
+    std::cout << std::setw(13) << "baseline" << std::setw(10) << "delta"
+              << std::setw(10) << "p" << "verdict";
+  }
+  std::cout << '\n';
+
+  for (const DayEntry *entry : days) {
+    for (int part = 1; part <= 2; part++) {
+      if (opts.part && opts.part != part) {
+        continue;
+      }
+
+      BenchRecord record{entry->day, part, file_size(entry->input),
+                         opts.commit,
+                         time_part(part == 1 ? entry->part1 : entry->part2,
+                                   opts)};
+      const double current = median(record.samples_ns);
+
+      std::cout << std::left << std::setw(5) << record.day << std::setw(6)
+                << record.part << std::setw(10) << record.input_bytes
+                << std::setw(13) << format_ns(current);
+
+      if (!baseline.empty()) {
+        const auto base =
+            find_baseline(baseline, record.day, record.part,
+                          record.input_bytes, opts.baseline_commit);
+        if (!base) {
+          std::cout << "(no baseline)";
+        } else {
+          const double previous = median(base->samples_ns);
+          const double delta_pct = (current - previous) / previous * 100;
+          const auto test = mann_whitney_u(base->samples_ns, record.samples_ns);
+          const bool significant = test.p_value < opts.alpha;
+
+          const char *verdict = "same";
+          if (significant && delta_pct > opts.threshold_pct) {
+            verdict = "REGRESSION";
+            regressions++;
+          } else if (significant && delta_pct < -opts.threshold_pct) {
+            verdict = "faster";
+          }
+
+          std::ostringstream delta;
+          delta << std::showpos << std::fixed << std::setprecision(1)
+                << delta_pct << '%';
+          std::cout << std::setw(13) << format_ns(previous) << std::setw(10)
+                    << delta.str() << std::setw(10) << std::setprecision(3)
+                    << test.p_value << verdict << " (vs " << base->commit
+                    << ")";
+        }
+      }
+      std::cout << '\n';
+
+      results.push_back(std::move(record));
+    }
+  }
+
+  if (!opts.save_path.empty()) {
+    try {
+      save_baseline(opts.save_path, results);
+    } catch (const std::runtime_error &e) {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+    std::cout << "Saved " << results.size() << " results to "
+              << opts.save_path << '\n';
+  }
+
+  if (regressions) {
+    std::cout << regressions << " regression(s) above " << opts.threshold_pct
+              << "% at alpha " << opts.alpha << '\n';
+    return EXIT_REGRESSION;
+  }
+  return 0;
+}
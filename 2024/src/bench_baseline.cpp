@@ -0,0 +1,293 @@
+#include "bench_baseline.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+// Minimal reader for the JSON subset written by save_baseline: objects,
+// arrays, strings without escapes other than \" and \\, and numbers.
+class JsonReader {
+public:
+  explicit JsonReader(std::string_view text) : text(text) {}
+
+  std::vector<BenchRecord> parse_baseline() {
+    std::vector<BenchRecord> records;
+    expect('{');
+    if (try_consume('}')) {
+      return records;
+    }
+    do {
+      const std::string key = parse_string();
+      expect(':');
+      if (key == "results") {
+        expect('[');
+        if (!try_consume(']')) {
+          do {
+            records.push_back(parse_record());
+          } while (try_consume(','));
+          expect(']');
+        }
+      } else {
+        skip_value();
+      }
+    } while (try_consume(','));
+    expect('}');
+    return records;
+  }
+
+private:
+  std::string_view text;
+  size_t pos = 0;
+
+  [[noreturn]] void fail(const std::string &what) const {
+    throw std::runtime_error("baseline: " + what + " at offset " +
+                             std::to_string(pos));
+  }
+
+  void skip_ws() {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(
+                                    text[pos]))) {
+      pos++;
+    }
+  }
+
+  bool try_consume(char c) {
+    skip_ws();
+    if (pos < text.size() && text[pos] == c) {
+      pos++;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!try_consume(c)) {
+      fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  std::string parse_string() {
+    expect('"');
+    std::string out;
+    while (pos < text.size() && text[pos] != '"') {
+      if (text[pos] == '\\' && pos + 1 < text.size()) {
+        pos++;
+      }
+      out += text[pos++];
+    }
+    expect('"');
+    return out;
+  }
+
+  double parse_number() {
+    skip_ws();
+    const size_t start = pos;
+    while (pos < text.size() &&
+           (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+            text[pos] == '-' || text[pos] == '+' || text[pos] == '.' ||
+            text[pos] == 'e' || text[pos] == 'E')) {
+      pos++;
+    }
+    if (start == pos) {
+      fail("expected number");
+    }
+    return std::stod(std::string(text.substr(start, pos - start)));
+  }
+
+  void skip_value() {
+    skip_ws();
+    if (pos >= text.size()) {
+      fail("unexpected end of input");
+    }
+    if (text[pos] == '"') {
+      parse_string();
+    } else if (text[pos] == '[' || text[pos] == '{') {
+      const char close = text[pos] == '[' ? ']' : '}';
+      pos++;
+      if (try_consume(close)) {
+        return;
+      }
+      do {
+        if (close == '}') {
+          parse_string();
+          expect(':');
+        }
+        skip_value();
+      } while (try_consume(','));
+      expect(close);
+    } else {
+      parse_number();
+    }
+  }
+
+  BenchRecord parse_record() {
+    BenchRecord record{};
+    expect('{');
+    do {
+      const std::string key = parse_string();
+      expect(':');
+      if (key == "day") {
+        record.day = static_cast<int>(parse_number());
+      } else if (key == "part") {
+        record.part = static_cast<int>(parse_number());
+      } else if (key == "input_bytes") {
+        record.input_bytes = static_cast<std::uint64_t>(parse_number());
+      } else if (key == "commit") {
+        record.commit = parse_string();
+      } else if (key == "samples_ns") {
+        expect('[');
+        if (!try_consume(']')) {
+          do {
+            record.samples_ns.push_back(parse_number());
+          } while (try_consume(','));
+          expect(']');
+        }
+      } else {
+        skip_value();
+      }
+    } while (try_consume(','));
+    expect('}');
+    return record;
+  }
+};
+
+std::string quote(const std::string &s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+} // namespace
+
+std::vector<BenchRecord> load_baseline(const std::string &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return {};
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return JsonReader(buffer.str()).parse_baseline();
+}
+
+void save_baseline(const std::string &path,
+                   const std::vector<BenchRecord> &records) {
+  auto key = [](const BenchRecord &r) {
+    return std::tie(r.day, r.part, r.input_bytes, r.commit);
+  };
+
+  std::vector<BenchRecord> merged = load_baseline(path);
+  for (const auto &record : records) {
+    std::erase_if(merged, [&](const BenchRecord &old) {
+      return key(old) == key(record);
+    });
+    merged.push_back(record);
+  }
+
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("baseline: cannot write " + path);
+  }
+
+  file << "{\n  \"results\": [";
+  for (size_t i = 0; i < merged.size(); i++) {
+    const auto &r = merged[i];
+    file << (i ? ",\n" : "\n") << "    {\"day\": " << r.day
+         << ", \"part\": " << r.part << ", \"input_bytes\": " << r.input_bytes
+         << ", \"commit\": " << quote(r.commit) << ", \"samples_ns\": [";
+    for (size_t j = 0; j < r.samples_ns.size(); j++) {
+      file << (j ? ", " : "") << static_cast<long long>(r.samples_ns[j]);
+    }
+    file << "]}";
+  }
+  file << "\n  ]\n}\n";
+}
+
+std::optional<BenchRecord>
+find_baseline(const std::vector<BenchRecord> &baseline, int day, int part,
+              std::uint64_t input_bytes, const std::string &commit) {
+  for (auto it = baseline.rbegin(); it != baseline.rend(); ++it) {
+    if (it->day == day && it->part == part &&
+        it->input_bytes == input_bytes &&
+        (commit.empty() || it->commit == commit)) {
+      return *it;
+    }
+  }
+  return std::nullopt;
+}
+
+MannWhitneyResult mann_whitney_u(const std::vector<double> &baseline,
+                                 const std::vector<double> &current) {
+  const double n1 = current.size();
+  const double n2 = baseline.size();
+  if (n1 == 0 || n2 == 0) {
+    return {0, 0, 1};
+  }
+
+  // Pool both samples, tagging the current ones, and rank with averaged ties.
+  std::vector<std::pair<double, bool>> pooled;
+  pooled.reserve(current.size() + baseline.size());
+  for (double v : current) {
+    pooled.emplace_back(v, true);
+  }
+  for (double v : baseline) {
+    pooled.emplace_back(v, false);
+  }
+  std::sort(pooled.begin(), pooled.end());
+
+  const double n = pooled.size();
+  double rank_sum = 0;
+  double tie_term = 0;
+  for (size_t i = 0; i < pooled.size();) {
+    size_t j = i;
+    while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+      j++;
+    }
+    const double ties = j - i;
+    const double avg_rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; k++) {
+      if (pooled[k].second) {
+        rank_sum += avg_rank;
+      }
+    }
+    tie_term += ties * ties * ties - ties;
+    i = j;
+  }
+
+  const double u = rank_sum - n1 * (n1 + 1) / 2;
+  const double mean = n1 * n2 / 2;
+  const double variance =
+      n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (variance <= 0) {
+    return {u, 0, 1};
+  }
+
+  const double diff = u - mean;
+  const double corrected = std::max(std::abs(diff) - 0.5, 0.0);
+  const double z = std::copysign(corrected / std::sqrt(variance), diff);
+  return {u, z, std::erfc(std::abs(z) / std::sqrt(2.0))};
+}
+
+double median(std::vector<double> samples) {
+  if (samples.empty()) {
+    return 0;
+  }
+  const size_t mid = samples.size() / 2;
+  std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+  if (samples.size() % 2) {
+    return samples[mid];
+  }
+  const double upper = samples[mid];
+  return (*std::max_element(samples.begin(), samples.begin() + mid) + upper) /
+         2;
+}
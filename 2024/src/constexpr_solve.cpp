@@ -0,0 +1,396 @@
+#include "constexpr_solve.h"
+#include "embedded_inputs.h"
+#include "engine.h"
+#include "input.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Compile-time ports of the day 1, 2, 5, 13 and 14 solvers. Every answer
+// below is a constexpr variable, so the compiler evaluates the whole solve
+// over the embedded input and the binary only carries the numbers.
+
+namespace {
+
+constexpr std::string_view input_of(const char *path) {
+  for (const auto &input : EMBEDDED_INPUTS) {
+    if (input.path == path) {
+      return input.data;
+    }
+  }
+  return {};
+}
+
+constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Pulls signed integers out of text, skipping whatever separates them.
+class IntScanner {
+public:
+  constexpr explicit IntScanner(std::string_view text) : text(text) {}
+
+  constexpr bool next(long long &out) {
+    while (pos < text.size() && !is_digit(text[pos]) &&
+           !(text[pos] == '-' && pos + 1 < text.size() &&
+             is_digit(text[pos + 1]))) {
+      pos++;
+    }
+    if (pos >= text.size()) {
+      return false;
+    }
+    const bool negative = text[pos] == '-';
+    if (negative) {
+      pos++;
+    }
+    long long value = 0;
+    while (pos < text.size() && is_digit(text[pos])) {
+      value = value * 10 + (text[pos++] - '0');
+    }
+    out = negative ? -value : value;
+    return true;
+  }
+
+private:
+  std::string_view text;
+  size_t pos = 0;
+};
+
+constexpr std::vector<std::string_view> split_lines(std::string_view text) {
+  std::vector<std::string_view> lines;
+  while (!text.empty()) {
+    const size_t end = text.find('\n');
+    lines.push_back(text.substr(0, end));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(end + 1);
+  }
+  return lines;
+}
+
+constexpr std::vector<long long> parse_ints(std::string_view text) {
+  std::vector<long long> values;
+  IntScanner scanner(text);
+  long long value;
+  while (scanner.next(value)) {
+    values.push_back(value);
+  }
+  return values;
+}
+
+constexpr long long abs_ll(long long x) { return x < 0 ? -x : x; }
+
+// Day 1
+
+constexpr long long day01_part1(std::string_view input) {
+  const auto values = parse_ints(input);
+  std::vector<long long> left, right;
+  for (size_t i = 0; i + 1 < values.size(); i += 2) {
+    left.push_back(values[i]);
+    right.push_back(values[i + 1]);
+  }
+  std::sort(left.begin(), left.end());
+  std::sort(right.begin(), right.end());
+
+  long long dist = 0;
+  for (size_t i = 0; i < left.size(); i++) {
+    dist += abs_ll(left[i] - right[i]);
+  }
+  return dist;
+}
+
+constexpr long long day01_part2(std::string_view input) {
+  const auto values = parse_ints(input);
+  std::vector<long long> left, right;
+  for (size_t i = 0; i + 1 < values.size(); i += 2) {
+    left.push_back(values[i]);
+    right.push_back(values[i + 1]);
+  }
+  std::sort(right.begin(), right.end());
+
+  long long similarity_score = 0;
+  for (long long l : left) {
+    const auto [lo, hi] = std::equal_range(right.begin(), right.end(), l);
+    similarity_score += l * (hi - lo);
+  }
+  return similarity_score;
+}
+
+// Day 2
+
+constexpr bool is_safe(const std::vector<long long> &report) {
+  if (report.size() < 2) {
+    return true;
+  }
+  const bool is_increasing = report[1] > report[0];
+  for (size_t i = 0; i + 1 < report.size(); i++) {
+    const long long left = report[i];
+    const long long right = report[i + 1];
+    if (left == right || (is_increasing ? left > right : left < right) ||
+        abs_ll(left - right) > 3) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool is_safe_part_2(const std::vector<long long> &report) {
+  if (is_safe(report)) {
+    return true;
+  }
+  for (size_t i = 0; i < report.size(); i++) {
+    std::vector<long long> without;
+    for (size_t j = 0; j < report.size(); j++) {
+      if (j != i) {
+        without.push_back(report[j]);
+      }
+    }
+    if (is_safe(without)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <bool Dampened> constexpr long long day02(std::string_view input) {
+  long long safe_reports = 0;
+  for (auto line : split_lines(input)) {
+    const auto report = parse_ints(line);
+    if (report.empty()) {
+      continue;
+    }
+    if (Dampened ? is_safe_part_2(report) : is_safe(report)) {
+      safe_reports++;
+    }
+  }
+  return safe_reports;
+}
+
+// Day 5
+
+struct PageRules {
+  long long limit = 0;
+  std::vector<char> before; // before[a * limit + b]: rule "a|b" exists
+
+  constexpr bool contains(long long a, long long b) const {
+    return a < limit && b < limit && before[a * limit + b];
+  }
+};
+
+constexpr long long day05(std::string_view input, bool corrected) {
+  std::vector<std::pair<long long, long long>> rule_list;
+  std::vector<std::vector<long long>> updates;
+  long long max_page = 0;
+
+  bool parsingRules = true;
+  for (auto line : split_lines(input)) {
+    if (line.empty()) {
+      parsingRules = false;
+      continue;
+    }
+    const auto values = parse_ints(line);
+    for (long long v : values) {
+      max_page = std::max(max_page, v);
+    }
+    if (parsingRules) {
+      rule_list.emplace_back(values[0], values[1]);
+    } else {
+      updates.push_back(values);
+    }
+  }
+
+  PageRules rules;
+  rules.limit = max_page + 1;
+  rules.before.assign(rules.limit * rules.limit, 0);
+  for (const auto &[a, b] : rule_list) {
+    rules.before[a * rules.limit + b] = 1;
+  }
+
+  long long sum = 0;
+  for (auto update : updates) {
+    bool valid = true;
+    for (size_t i = 0; i < update.size() && valid; i++) {
+      for (size_t j = i + 1; j < update.size(); j++) {
+        if (rules.contains(update[j], update[i])) {
+          valid = false;
+          break;
+        }
+      }
+    }
+
+    if (!corrected && valid) {
+      sum += update[update.size() / 2];
+    } else if (corrected && !valid) {
+      // Stable insertion sort with the runtime solver's comparator, which
+      // std::stable_sort uses there but is not constexpr.
+      auto less = [&rules](long long a, long long b) {
+        return rules.contains(a, b) || (!rules.contains(b, a) && a < b);
+      };
+      for (size_t i = 1; i < update.size(); i++) {
+        const long long value = update[i];
+        size_t j = i;
+        while (j > 0 && less(value, update[j - 1])) {
+          update[j] = update[j - 1];
+          j--;
+        }
+        update[j] = value;
+      }
+      sum += update[update.size() / 2];
+    }
+  }
+  return sum;
+}
+
+// Day 13
+
+constexpr long long solve_machine(long long ax, long long ay, long long bx,
+                                  long long by, long long px, long long py,
+                                  long long limit) {
+  const long long det = ax * by - ay * bx;
+  if (det == 0) {
+    if (limit < 0) {
+      return -1;
+    }
+    // Degenerate buttons: fall back to the bounded search of day13.c.
+    for (long long a = 0; a <= limit; a++) {
+      for (long long b = 0; b <= limit; b++) {
+        if (a * ax + b * bx == px && a * ay + b * by == py) {
+          return 3 * a + b;
+        }
+      }
+    }
+    return -1;
+  }
+
+  const long long a = (px * by - py * bx) / det;
+  const long long b = (ax * py - ay * px) / det;
+  if (a * det != (px * by - py * bx) || b * det != (ax * py - ay * px)) {
+    return -1;
+  }
+  if (a < 0 || b < 0 || (limit >= 0 && (a > limit || b > limit))) {
+    return -1;
+  }
+  return 3 * a + b;
+}
+
+constexpr long long day13(std::string_view input, long long offset,
+                          long long limit) {
+  const auto values = parse_ints(input);
+  long long total_tokens = 0;
+  for (size_t i = 0; i + 5 < values.size(); i += 6) {
+    const long long tokens =
+        solve_machine(values[i], values[i + 1], values[i + 2], values[i + 3],
+                      values[i + 4] + offset, values[i + 5] + offset, limit);
+    if (tokens >= 0) {
+      total_tokens += tokens;
+    }
+  }
+  return total_tokens;
+}
+
+// Day 14
+
+constexpr int WIDTH = 101;
+constexpr int HEIGHT = 103;
+constexpr int SECONDS = 100;
+
+constexpr int positive_mod(int x, int m) {
+  return x % m < 0 ? x % m + m : x % m;
+}
+
+constexpr long long day14_part1(std::string_view input) {
+  const auto values = parse_ints(input);
+  std::array<std::array<int, 2>, 2> count = {};
+  for (size_t i = 0; i + 3 < values.size(); i += 4) {
+    const int px = positive_mod(values[i] + values[i + 2] * SECONDS, WIDTH);
+    const int py =
+        positive_mod(values[i + 1] + values[i + 3] * SECONDS, HEIGHT);
+    if (px != WIDTH / 2 && py != HEIGHT / 2) {
+      count[px / (WIDTH / 2 + 1)][py / (HEIGHT / 2 + 1)]++;
+    }
+  }
+  return count[0][0] * count[0][1] * count[1][0] * count[1][1];
+}
+
+// Time in [0, period) at which one axis is most clustered.
+constexpr int min_variance_time(const std::vector<long long> &values,
+                                size_t axis, int period) {
+  const size_t robots = values.size() / 4;
+  double min_var = std::numeric_limits<double>::max();
+  int best = 0;
+  for (int t = 0; t < period; ++t) {
+    std::vector<int> curr;
+    double mean = 0;
+    for (size_t i = 0; i < robots; ++i) {
+      const int x =
+          positive_mod(values[4 * i + axis] + values[4 * i + 2 + axis] * t,
+                       period);
+      curr.push_back(x);
+      mean += x;
+    }
+    mean /= robots;
+
+    double variance = 0;
+    for (int x : curr) {
+      variance += (x - mean) * (x - mean);
+    }
+    if (variance < min_var) {
+      min_var = variance;
+      best = t;
+    }
+  }
+  return best;
+}
+
+constexpr long long day14_part2(std::string_view input) {
+  const auto values = parse_ints(input);
+  const int best_x = min_variance_time(values, 0, WIDTH);
+  const int best_y = min_variance_time(values, 1, HEIGHT);
+
+  int w_inv = 1;
+  for (int i = 1; i < HEIGHT; ++i) {
+    if ((WIDTH * i) % HEIGHT == 1) {
+      w_inv = i;
+      break;
+    }
+  }
+  const int k = ((w_inv * (best_y - best_x)) % HEIGHT + HEIGHT) % HEIGHT;
+  return best_x + static_cast<long long>(k) * WIDTH;
+}
+
+constexpr long long DAY01_PART1 = day01_part1(input_of("../inputs/day01.txt"));
+constexpr long long DAY01_PART2 = day01_part2(input_of("../inputs/day01.txt"));
+constexpr long long DAY02_PART1 = day02<false>(input_of("../inputs/day02.txt"));
+constexpr long long DAY02_PART2 = day02<true>(input_of("../inputs/day02.txt"));
+constexpr long long DAY05_PART1 = day05(input_of("../inputs/day05.txt"), false);
+constexpr long long DAY05_PART2 = day05(input_of("../inputs/day05.txt"), true);
+constexpr long long DAY13_PART1 =
+    day13(input_of("../inputs/day13.txt"), 0, 100);
+constexpr long long DAY13_PART2 =
+    day13(input_of("../inputs/day13.txt"), 10000000000000LL, -1);
+constexpr long long DAY14_PART1 = day14_part1(input_of("../inputs/day14.txt"));
+constexpr long long DAY14_PART2 = day14_part2(input_of("../inputs/day14.txt"));
+
+} // namespace
+
+extern "C" {
+int aoc_use_precomputed(const char *path) {
+  size_t size = 0;
+  return aoc_engine == AOC_ENGINE_FAST &&
+         std::string_view(aoc_input_path(path)) == path &&
+         aoc_embedded_input(path, &size) != nullptr;
+}
+
+long long day01_part1_precomputed(void) { return DAY01_PART1; }
+long long day01_part2_precomputed(void) { return DAY01_PART2; }
+long long day02_part1_precomputed(void) { return DAY02_PART1; }
+long long day02_part2_precomputed(void) { return DAY02_PART2; }
+long long day05_part1_precomputed(void) { return DAY05_PART1; }
+long long day05_part2_precomputed(void) { return DAY05_PART2; }
+long long day13_part1_precomputed(void) { return DAY13_PART1; }
+long long day13_part2_precomputed(void) { return DAY13_PART2; }
+long long day14_part1_precomputed(void) { return DAY14_PART1; }
+long long day14_part2_precomputed(void) { return DAY14_PART2; }
+}
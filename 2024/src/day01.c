@@ -1,84 +1,796 @@
 #include "day01.h"
+#include "constexpr_solve.h"
+#include "engine.h"
+#include "input.h"
+#include <limits.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 static const char *FILE_NAME = "../inputs/day01.txt";
 
-// Compare function for qsort
-int compare(const void *a, const void *b) { return (*(int *)a - *(int *)b); }
+// Columns at least this long are radix sorted; below it qsort is cheaper
+// than the radix sort's fixed histogram cost.
+#define RADIX_SORT_MIN 256
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES 3 // 11 + 11 + 10 bits
+#define SIGN_BIT 0x80000000u
+// Inputs at least this long are sorted and reduced across the OpenMP team.
+#define PARALLEL_MIN (1 << 16)
+#define COLUMNS 2
 
-// Common function to read input data
-void read_input(int **left, int **right, int *size, int *max_num) {
-  FILE *file = fopen(FILE_NAME, "r");
-  if (file == NULL) {
-    printf("Error: Could not open file\n");
+// Compare function for qsort. Subtracting would overflow for operands of
+// opposite sign and large magnitude.
+static int compare(const void *a, const void *b) {
+  const int x = *(const int *)a;
+  const int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// LSD radix sort on 11-bit digits of the value with its sign bit flipped,
+// so negatives order first. One pass over the input builds all three
+// digit histograms, and a pass whose digit is the same for every value
+// (the top one, for IDs below 2^22) is skipped.
+static void radix_sort(int *values, int size) {
+  unsigned *scratch = malloc((size_t)size * sizeof(unsigned));
+  if (scratch == NULL) {
+    qsort(values, size, sizeof(int), compare);
     return;
   }
 
+  unsigned counts[RADIX_PASSES][RADIX_BUCKETS];
+  memset(counts, 0, sizeof(counts));
+  unsigned *src = (unsigned *)values;
+  for (int i = 0; i < size; i++) {
+    const unsigned key = src[i] ^ SIGN_BIT;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+      counts[pass][key >> (pass * RADIX_BITS) & (RADIX_BUCKETS - 1)]++;
+    }
+  }
+
+  unsigned *dst = scratch;
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    const int shift = pass * RADIX_BITS;
+    unsigned *count = counts[pass];
+    if (count[(src[0] ^ SIGN_BIT) >> shift & (RADIX_BUCKETS - 1)] ==
+        (unsigned)size) {
+      continue;
+    }
+
+    unsigned offset = 0;
+    for (int digit = 0; digit < RADIX_BUCKETS; digit++) {
+      const unsigned n = count[digit];
+      count[digit] = offset;
+      offset += n;
+    }
+    for (int i = 0; i < size; i++) {
+      const unsigned key = src[i];
+      dst[count[(key ^ SIGN_BIT) >> shift & (RADIX_BUCKETS - 1)]++] = key;
+    }
+
+    unsigned *sorted = dst;
+    dst = src;
+    src = sorted;
+  }
+
+  if (src != (unsigned *)values) {
+    memcpy(values, src, (size_t)size * sizeof(int));
+  }
+  free(scratch);
+}
+
+// radix_sort of both columns at once across the OpenMP team. In every
+// pass each thread histograms its slice of each column, then scatters it
+// from offsets that place the slices in thread order, keeping the pass
+// stable. Both columns share each fork and join.
+static void radix_sort_parallel(int *left, int *right, int size) {
+  const int max_threads = omp_get_max_threads();
+  unsigned *scratch = malloc(COLUMNS * (size_t)size * sizeof(unsigned));
+  unsigned(*counts)[COLUMNS][RADIX_BUCKETS] =
+      malloc(max_threads * sizeof(*counts));
+  if (scratch == NULL || counts == NULL) {
+    free(scratch);
+    free(counts);
+    radix_sort(left, size);
+    radix_sort(right, size);
+    return;
+  }
+
+  unsigned *const columns[COLUMNS] = {(unsigned *)left, (unsigned *)right};
+  unsigned *src[COLUMNS] = {columns[0], columns[1]};
+  unsigned *dst[COLUMNS] = {scratch, scratch + size};
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    const int shift = pass * RADIX_BITS;
+    bool skip[COLUMNS];
+
+#pragma omp parallel num_threads(max_threads)
+    {
+      const int t = omp_get_thread_num();
+      const int threads = omp_get_num_threads();
+      const size_t begin = (size_t)size * t / threads;
+      const size_t end = (size_t)size * (t + 1) / threads;
+
+      for (int c = 0; c < COLUMNS; c++) {
+        unsigned *count = counts[t][c];
+        memset(count, 0, sizeof(counts[t][c]));
+        for (size_t i = begin; i < end; i++) {
+          count[(src[c][i] ^ SIGN_BIT) >> shift & (RADIX_BUCKETS - 1)]++;
+        }
+      }
+
+#pragma omp barrier
+#pragma omp single
+      for (int c = 0; c < COLUMNS; c++) {
+        unsigned offset = 0;
+        skip[c] = false;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++) {
+          const unsigned before = offset;
+          for (int other = 0; other < threads; other++) {
+            const unsigned n = counts[other][c][digit];
+            counts[other][c][digit] = offset;
+            offset += n;
+          }
+          skip[c] |= offset - before == (unsigned)size;
+        }
+      }
+
+      for (int c = 0; c < COLUMNS; c++) {
+        if (skip[c]) {
+          continue;
+        }
+        unsigned *count = counts[t][c];
+        for (size_t i = begin; i < end; i++) {
+          const unsigned key = src[c][i];
+          dst[c][count[(key ^ SIGN_BIT) >> shift & (RADIX_BUCKETS - 1)]++] =
+              key;
+        }
+      }
+    }
+
+    for (int c = 0; c < COLUMNS; c++) {
+      if (!skip[c]) {
+        unsigned *sorted = dst[c];
+        dst[c] = src[c];
+        src[c] = sorted;
+      }
+    }
+  }
+
+  for (int c = 0; c < COLUMNS; c++) {
+    if (src[c] != columns[c]) {
+      memcpy(columns[c], src[c], (size_t)size * sizeof(unsigned));
+    }
+  }
+  free(scratch);
+  free(counts);
+}
+
+// The reference engine always uses qsort.
+static void sort_column(int *values, int size) {
+  if (aoc_engine != AOC_ENGINE_REFERENCE && size >= RADIX_SORT_MIN) {
+    radix_sort(values, size);
+  } else {
+    qsort(values, size, sizeof(int), compare);
+  }
+}
+
+static void sort_columns(int *left, int *right, int size) {
+  if (aoc_engine != AOC_ENGINE_REFERENCE && size >= PARALLEL_MIN &&
+      omp_get_max_threads() > 1) {
+    radix_sort_parallel(left, right, size);
+  } else {
+    sort_column(left, size);
+    sort_column(right, size);
+  }
+}
+
+// Bytes day 1 may spend holding pairs; 0 picks a quarter of physical
+// memory. Set by the driver before any solver runs.
+static size_t memory_limit = 0;
+
+void day01_set_memory_limit(size_t bytes) { memory_limit = bytes; }
+
+// What a pair costs while its run is sorted: both columns and the radix
+// sort's scratch copy of them.
+#define PAIR_BYTES (4 * sizeof(int))
+// Values each run being merged back buffers at a time.
+#define MERGE_BUFFER 4096
+
+// Pairs held in memory before they are sorted and spilled as a run.
+static int run_limit(void) {
+  size_t bytes = memory_limit;
+  if (bytes == 0) {
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    bytes = pages > 0 && page_size > 0 ? (size_t)pages * page_size / 4
+                                       : SIZE_MAX;
+  }
+  const size_t pairs = bytes / PAIR_BYTES;
+  if (pairs < RADIX_SORT_MIN) {
+    return RADIX_SORT_MIN;
+  }
+  return pairs > INT_MAX ? INT_MAX : (int)pairs;
+}
+
+// The pairs held in memory. min_num and max_num bound every value and 0.
+typedef struct {
+  int *left, *right;
+  int size, cap;
+  int min_num, max_num;
+} Pairs;
+
+// Sorted runs of both columns, back to back in one temp file per column.
+// Run i is values [bounds[i], bounds[i + 1]) of each file.
+typedef struct {
+  FILE *files[COLUMNS];
+  size_t *bounds;
+  int runs;
+} Spill;
+
+static bool grow_pairs(Pairs *pairs, int limit) {
   int cap = 10;
-  *size = 0;
-  *max_num = 0;
-  int left_n, right_n;
+  if (pairs->cap > 0) {
+    cap = pairs->cap > limit / 2 ? limit : pairs->cap * 2;
+  }
+  int *left = (int *)realloc(pairs->left, (size_t)cap * sizeof(int));
+  if (left == NULL) {
+    return false;
+  }
+  pairs->left = left;
+  int *right = (int *)realloc(pairs->right, (size_t)cap * sizeof(int));
+  if (right == NULL) {
+    return false;
+  }
+  pairs->right = right;
+  pairs->cap = cap;
+  return true;
+}
+
+// Sorts the pairs held and appends them to the spill as its next run.
+static bool spill_run(Spill *spill, Pairs *pairs) {
+  if (spill->runs == 0) {
+    for (int c = 0; c < COLUMNS; c++) {
+      spill->files[c] = tmpfile();
+      if (spill->files[c] == NULL) {
+        return false;
+      }
+    }
+  }
+  size_t *bounds =
+      (size_t *)realloc(spill->bounds, (spill->runs + 2) * sizeof(size_t));
+  if (bounds == NULL) {
+    return false;
+  }
+  if (spill->runs == 0) {
+    bounds[0] = 0;
+  }
+  spill->bounds = bounds;
 
-  *left = (int *)malloc(cap * sizeof(int));
-  *right = (int *)malloc(cap * sizeof(int));
+  sort_columns(pairs->left, pairs->right, pairs->size);
+  const int *columns[COLUMNS] = {pairs->left, pairs->right};
+  for (int c = 0; c < COLUMNS; c++) {
+    if (fwrite(columns[c], sizeof(int), pairs->size, spill->files[c]) !=
+        (size_t)pairs->size) {
+      return false;
+    }
+  }
+  bounds[spill->runs + 1] = bounds[spill->runs] + pairs->size;
+  spill->runs++;
+  pairs->size = 0;
+  return true;
+}
 
-  while (fscanf(file, "%d %d", &left_n, &right_n) == 2) {
-    if (*size >= cap) {
-      cap *= 2;
-      *left = (int *)realloc(*left, cap * sizeof(int));
-      *right = (int *)realloc(*right, cap * sizeof(int));
+static void free_input(Pairs *pairs, Spill *spill) {
+  free(pairs->left);
+  free(pairs->right);
+  for (int c = 0; c < COLUMNS; c++) {
+    if (spill->files[c] != NULL) {
+      fclose(spill->files[c]);
     }
+  }
+  free(spill->bounds);
+}
 
-    (*left)[*size] = left_n;
-    (*right)[*size] = right_n;
-    *max_num = (left_n > *max_num) ? left_n : *max_num;
-    *max_num = (right_n > *max_num) ? right_n : *max_num;
-    (*size)++;
+// Reads the input into `pairs` while it fits in run_limit() pairs. Past
+// that, every full batch is sorted and spilled as a run, the last one too,
+// and `pairs` is released; spill->runs is 0 if the input fit. Returns
+// false, having printed why, if the input could not be read.
+static bool read_input(Pairs *pairs, Spill *spill) {
+  FILE *file = aoc_open_input(FILE_NAME);
+  if (file == NULL) {
+    printf("Error: Could not open file\n");
+    return false;
   }
 
+  const int limit = run_limit();
+  bool ok = true;
+  int left_n, right_n;
+  while (ok && fscanf(file, "%d %d", &left_n, &right_n) == 2) {
+    if (pairs->size == limit) {
+      ok = spill_run(spill, pairs);
+    } else if (pairs->size == pairs->cap) {
+      ok = grow_pairs(pairs, limit);
+    }
+    if (!ok) {
+      break;
+    }
+
+    pairs->left[pairs->size] = left_n;
+    pairs->right[pairs->size] = right_n;
+    pairs->max_num = (left_n > pairs->max_num) ? left_n : pairs->max_num;
+    pairs->max_num = (right_n > pairs->max_num) ? right_n : pairs->max_num;
+    pairs->min_num = (left_n < pairs->min_num) ? left_n : pairs->min_num;
+    pairs->min_num = (right_n < pairs->min_num) ? right_n : pairs->min_num;
+    pairs->size++;
+  }
   fclose(file);
+
+  if (ok && spill->runs > 0) {
+    ok = spill_run(spill, pairs);
+    free(pairs->left);
+    free(pairs->right);
+    *pairs = (Pairs){0};
+  }
+  if (!ok) {
+    printf("Error: Could not hold or spill the input\n");
+  }
+  return ok;
 }
 
-void day01_part1(void) {
-  printf("Day 1, Part 1 solution\n");
-  int *left, *right, size, max_num;
+// One spilled run being read back, MERGE_BUFFER values at a time.
+typedef struct {
+  int buffer[MERGE_BUFFER];
+  int pos, len;
+  size_t next, end; // file offsets, in values
+} RunCursor;
+
+// The runs of one spilled column merged into a single sorted stream: a
+// binary min-heap of run cursors keyed by their current value. Memory is
+// one buffer per run, however long the runs are.
+typedef struct {
+  int fd;
+  RunCursor *cursors;
+  int *heap;
+  int heap_size;
+  bool failed; // a read came back short
+} MergeStream;
+
+static bool fill_cursor(MergeStream *s, RunCursor *cursor) {
+  const size_t remaining = cursor->end - cursor->next;
+  const size_t n = remaining < MERGE_BUFFER ? remaining : MERGE_BUFFER;
+  if (n == 0) {
+    return false;
+  }
+  if (pread(s->fd, cursor->buffer, n * sizeof(int),
+            (off_t)(cursor->next * sizeof(int))) !=
+      (ssize_t)(n * sizeof(int))) {
+    s->failed = true;
+    return false;
+  }
+  cursor->pos = 0;
+  cursor->len = (int)n;
+  cursor->next += n;
+  return true;
+}
+
+static int head_value(const MergeStream *s, int i) {
+  const RunCursor *cursor = &s->cursors[s->heap[i]];
+  return cursor->buffer[cursor->pos];
+}
+
+static void sift_down(MergeStream *s, int i) {
+  for (;;) {
+    int smallest = i;
+    for (int child = 2 * i + 1; child <= 2 * i + 2; child++) {
+      if (child < s->heap_size &&
+          head_value(s, child) < head_value(s, smallest)) {
+        smallest = child;
+      }
+    }
+    if (smallest == i) {
+      return;
+    }
+    const int swap = s->heap[i];
+    s->heap[i] = s->heap[smallest];
+    s->heap[smallest] = swap;
+    i = smallest;
+  }
+}
+
+static void close_merge(MergeStream *s) {
+  free(s->cursors);
+  free(s->heap);
+}
+
+static bool open_merge(MergeStream *s, FILE *file, const Spill *spill) {
+  *s = (MergeStream){fileno(file), NULL, NULL, 0, false};
+  if (fflush(file) != 0) {
+    return false;
+  }
+  s->cursors = (RunCursor *)malloc(spill->runs * sizeof(RunCursor));
+  s->heap = (int *)malloc(spill->runs * sizeof(int));
+  if (s->cursors == NULL || s->heap == NULL) {
+    close_merge(s);
+    return false;
+  }
+  for (int run = 0; run < spill->runs; run++) {
+    RunCursor *cursor = &s->cursors[run];
+    cursor->next = spill->bounds[run];
+    cursor->end = spill->bounds[run + 1];
+    if (fill_cursor(s, cursor)) {
+      s->heap[s->heap_size++] = run;
+    }
+  }
+  for (int i = s->heap_size / 2 - 1; i >= 0; i--) {
+    sift_down(s, i);
+  }
+  if (s->failed) {
+    close_merge(s);
+    return false;
+  }
+  return true;
+}
 
-  read_input(&left, &right, &size, &max_num);
+// Takes the smallest value left in the stream.
+static bool merge_next(MergeStream *s, int *value) {
+  if (s->heap_size == 0) {
+    return false;
+  }
+  RunCursor *cursor = &s->cursors[s->heap[0]];
+  *value = cursor->buffer[cursor->pos++];
+  if (cursor->pos == cursor->len && !fill_cursor(s, cursor)) {
+    s->heap[0] = s->heap[--s->heap_size];
+  }
+  sift_down(s, 0);
+  return true;
+}
 
-  qsort(left, size, sizeof(int), compare);
-  qsort(right, size, sizeof(int), compare);
+// A merged stream per column over the same spill, read in lockstep by the
+// callers, so the i-th smallest values of the columns meet as they do in
+// the sorted arrays.
+static bool open_merges(MergeStream streams[COLUMNS], const Spill *spill) {
+  for (int c = 0; c < COLUMNS; c++) {
+    if (!open_merge(&streams[c], spill->files[c], spill)) {
+      while (c-- > 0) {
+        close_merge(&streams[c]);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool close_merges(MergeStream streams[COLUMNS]) {
+  bool ok = true;
+  for (int c = 0; c < COLUMNS; c++) {
+    ok &= !streams[c].failed;
+    close_merge(&streams[c]);
+  }
+  return ok;
+}
+
+static bool distance_spilled(const Spill *spill, long long *dist) {
+  MergeStream streams[COLUMNS];
+  if (!open_merges(streams, spill)) {
+    return false;
+  }
+  long long sum = 0;
+  int left_n, right_n;
+  while (merge_next(&streams[0], &left_n) &&
+         merge_next(&streams[1], &right_n)) {
+    sum += llabs((long long)left_n - right_n);
+  }
+  *dist = sum;
+  return close_merges(streams);
+}
+
+void day01_part1(void) {
+  printf("Day 1, Part 1 solution\n");
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME)) {
+    printf("Total Distance: %lld\n", day01_part1_precomputed());
+    return;
+  }
+#endif
+  Pairs pairs = {0};
+  Spill spill = {0};
+  if (!read_input(&pairs, &spill)) {
+    free_input(&pairs, &spill);
+    return;
+  }
 
   long long dist = 0;
-  for (int i = 0; i < size; i++) {
-    dist += abs(left[i] - right[i]);
+  if (spill.runs > 0) {
+    if (!distance_spilled(&spill, &dist)) {
+      printf("Error: Could not merge the spilled runs\n");
+      free_input(&pairs, &spill);
+      return;
+    }
+  } else {
+    sort_columns(pairs.left, pairs.right, pairs.size);
+    const int *left = pairs.left, *right = pairs.right;
+    const int size = pairs.size;
+#pragma omp parallel for reduction(+ : dist) if (size >= PARALLEL_MIN)
+    for (int i = 0; i < size; i++) {
+      dist += llabs((long long)left[i] - right[i]);
+    }
   }
 
   printf("Total Distance: %lld\n", dist);
 
-  free(left);
-  free(right);
+  free_input(&pairs, &spill);
 }
 
-void day01_part2(void) {
-  printf("Day 1, Part 2 solution\n");
-  int *left, *right, size, max_num;
-
-  read_input(&left, &right, &size, &max_num);
+// The similarity engines store the score and return true, or return false
+// when they cannot allocate their table.
 
-  int *freq = (int *)calloc(max_num + 1, sizeof(int));
+// The original engine: a count per possible value, indexed by value. Needs
+// non-negative values and max_num + 1 counters however few are distinct.
+static bool similarity_dense(const int *left, const int *right, int size,
+                             int max_num, long long *score) {
+  int *freq = (int *)calloc((size_t)max_num + 1, sizeof(int));
+  if (freq == NULL) {
+    return false;
+  }
   for (int i = 0; i < size; i++) {
     freq[right[i]]++;
   }
 
   long long similarity_score = 0;
+#pragma omp parallel for reduction(+ : similarity_score)                      \
+    if (size >= PARALLEL_MIN)
   for (int i = 0; i < size; i++) {
     similarity_score += (long long)left[i] * freq[left[i]];
   }
 
-  printf("Similarity Score: %lld\n", similarity_score);
-
-  free(left);
-  free(right);
   free(freq);
+  *score = similarity_score;
+  return true;
+}
+
+static bool is_sorted(const int *values, int size) {
+  for (int i = 1; i < size; i++) {
+    if (values[i - 1] > values[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// First index at or after i that starts a run of equal values.
+static int run_start(const int *values, int size, int i) {
+  while (i > 0 && i < size && values[i] == values[i - 1]) {
+    i++;
+  }
+  return i;
+}
+
+// First index whose value is not below `value`.
+static int lower_bound(const int *values, int size, int value) {
+  int lo = 0, hi = size;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (values[mid] < value) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Both columns sorted: walk left[i, i_end) and right[j, j_end) together,
+// and each value present in both adds value * (its run length in left) *
+// (its run length in right).
+static long long merge_runs(const int *left, int i, int i_end,
+                            const int *right, int j, int j_end) {
+  long long similarity_score = 0;
+  while (i < i_end && j < j_end) {
+    if (left[i] < right[j]) {
+      i++;
+    } else if (right[j] < left[i]) {
+      j++;
+    } else {
+      const int value = left[i];
+      long long in_left = 0, in_right = 0;
+      for (; i < i_end && left[i] == value; i++) {
+        in_left++;
+      }
+      for (; j < j_end && right[j] == value; j++) {
+        in_right++;
+      }
+      similarity_score += value * in_left * in_right;
+    }
+  }
+  return similarity_score;
+}
+
+// merge_runs over the whole columns, needing no extra memory. Each thread
+// takes a slice of left cut at run boundaries and the part of right that
+// holds the same values.
+static long long similarity_merge(const int *left, const int *right,
+                                  int size) {
+  long long similarity_score = 0;
+#pragma omp parallel reduction(+ : similarity_score) if (size >= PARALLEL_MIN)
+  {
+    const int t = omp_get_thread_num();
+    const int threads = omp_get_num_threads();
+    const int begin = run_start(left, size, (long long)size * t / threads);
+    const int end = run_start(left, size, (long long)size * (t + 1) / threads);
+    const int right_begin =
+        begin < size ? lower_bound(right, size, left[begin]) : size;
+    const int right_end =
+        end < size ? lower_bound(right, size, left[end]) : size;
+    similarity_score +=
+        merge_runs(left, begin, end, right, right_begin, right_end);
+  }
+  return similarity_score;
+}
+
+// Open-addressed counts of the right column's values, doubling at half
+// load, so the table holds about two slots per distinct value.
+typedef struct {
+  int value;
+  int count; // 0 marks an empty slot
+} Bucket;
+
+typedef struct {
+  Bucket *buckets;
+  int bits;
+  int used;
+} Histogram;
+
+static uint32_t bucket_of(int value, int bits) {
+  return (uint32_t)value * 0x9E3779B1u >> (32 - bits);
+}
+
+static Bucket *find_bucket(const Histogram *h, int value) {
+  const uint32_t mask = (1u << h->bits) - 1;
+  uint32_t slot = bucket_of(value, h->bits);
+  while (h->buckets[slot].count != 0 && h->buckets[slot].value != value) {
+    slot = (slot + 1) & mask;
+  }
+  return &h->buckets[slot];
+}
+
+static bool grow_histogram(Histogram *h) {
+  Histogram grown = {calloc((size_t)1 << (h->bits + 1), sizeof(Bucket)),
+                     h->bits + 1, h->used};
+  if (grown.buckets == NULL) {
+    return false;
+  }
+  for (size_t slot = 0; slot < (size_t)1 << h->bits; slot++) {
+    if (h->buckets[slot].count != 0) {
+      *find_bucket(&grown, h->buckets[slot].value) = h->buckets[slot];
+    }
+  }
+  free(h->buckets);
+  *h = grown;
+  return true;
+}
+
+static bool similarity_hash(const int *left, const int *right, int size,
+                            long long *score) {
+  Histogram h = {calloc(64, sizeof(Bucket)), 6, 0};
+  if (h.buckets == NULL) {
+    return false;
+  }
+  for (int i = 0; i < size; i++) {
+    Bucket *bucket = find_bucket(&h, right[i]);
+    if (bucket->count == 0) {
+      if (2 * (h.used + 1) > 1 << h.bits) {
+        if (!grow_histogram(&h)) {
+          free(h.buckets);
+          return false;
+        }
+        bucket = find_bucket(&h, right[i]);
+      }
+      bucket->value = right[i];
+      h.used++;
+    }
+    bucket->count++;
+  }
+
+  long long similarity_score = 0;
+#pragma omp parallel for reduction(+ : similarity_score)                      \
+    if (size >= PARALLEL_MIN)
+  for (int i = 0; i < size; i++) {
+    similarity_score += (long long)left[i] * find_bucket(&h, left[i])->count;
+  }
+
+  free(h.buckets);
+  *score = similarity_score;
+  return true;
+}
+
+// Picks the engine that needs the least memory: none when the columns are
+// already sorted, otherwise the dense table while it is no larger than the
+// hash would be at worst (two 8-byte slots per row), otherwise the hash.
+// The reference engine always uses the dense table.
+static bool similarity(const int *left, const int *right, int size,
+                       int min_num, int max_num, long long *score) {
+  const bool dense_fits = min_num >= 0;
+  if (aoc_engine == AOC_ENGINE_REFERENCE && dense_fits) {
+    return similarity_dense(left, right, size, max_num, score);
+  }
+  if (is_sorted(left, size) && is_sorted(right, size)) {
+    *score = similarity_merge(left, right, size);
+    return true;
+  }
+  const size_t dense_bytes = ((size_t)max_num + 1) * sizeof(int);
+  const size_t hash_bytes = 2 * (size_t)size * sizeof(Bucket);
+  if (dense_fits && dense_bytes <= hash_bytes) {
+    return similarity_dense(left, right, size, max_num, score);
+  }
+  return similarity_hash(left, right, size, score);
+}
+
+// merge_runs over the two merged streams of a spill.
+static bool similarity_spilled(const Spill *spill, long long *score) {
+  MergeStream streams[COLUMNS];
+  if (!open_merges(streams, spill)) {
+    return false;
+  }
+  long long similarity_score = 0;
+  int left_n, right_n;
+  bool has_left = merge_next(&streams[0], &left_n);
+  bool has_right = merge_next(&streams[1], &right_n);
+  while (has_left && has_right) {
+    if (left_n < right_n) {
+      has_left = merge_next(&streams[0], &left_n);
+    } else if (right_n < left_n) {
+      has_right = merge_next(&streams[1], &right_n);
+    } else {
+      const int value = left_n;
+      long long in_left = 0, in_right = 0;
+      for (; has_left && left_n == value;
+           has_left = merge_next(&streams[0], &left_n)) {
+        in_left++;
+      }
+      for (; has_right && right_n == value;
+           has_right = merge_next(&streams[1], &right_n)) {
+        in_right++;
+      }
+      similarity_score += value * in_left * in_right;
+    }
+  }
+  *score = similarity_score;
+  return close_merges(streams);
+}
+
+void day01_part2(void) {
+  printf("Day 1, Part 2 solution\n");
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME)) {
+    printf("Similarity Score: %lld\n", day01_part2_precomputed());
+    return;
+  }
+#endif
+  Pairs pairs = {0};
+  Spill spill = {0};
+  if (!read_input(&pairs, &spill)) {
+    free_input(&pairs, &spill);
+    return;
+  }
+
+  long long similarity_score;
+  if (spill.runs > 0) {
+    if (similarity_spilled(&spill, &similarity_score)) {
+      printf("Similarity Score: %lld\n", similarity_score);
+    } else {
+      printf("Error: Could not merge the spilled runs\n");
+    }
+  } else if (similarity(pairs.left, pairs.right, pairs.size, pairs.min_num,
+                        pairs.max_num, &similarity_score)) {
+    printf("Similarity Score: %lld\n", similarity_score);
+  } else {
+    printf("Error: Could not allocate the similarity table\n");
+  }
+
+  free_input(&pairs, &spill);
 }
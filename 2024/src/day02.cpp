@@ -1,40 +1,47 @@
 #include "day02.h"
+#include "constexpr_solve.h"
+#include "line_stream.h"
+#include "small_vector.h"
+#include <charconv>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <string_view>
 #include <vector>
 
-static const std::string FILE_NAME = "../inputs/day02.txt";
-
-std::vector<std::vector<int>> read_levels(const std::string &fileName) {
-  std::ifstream file(fileName);
-  std::vector<std::vector<int>> levels;
-
-  if (!file.is_open()) {
-    return levels;
-  }
-
-  std::string line;
-  while (std::getline(file, line)) {
-    std::vector<int> row;
-    std::istringstream iss(line);
-    int num;
-
-    while (iss >> num) {
-      row.push_back(num);
+namespace {
+
+const std::string FILE_NAME = "../inputs/day02.txt";
+
+// Parser stage: turns each non-blank line into one report. The reader and
+// line stages in front of it keep only one chunk of the file in memory.
+Generator<std::vector<int>> parse_reports(Generator<std::string_view> lines) {
+  std::vector<int> row;
+
+  for (std::string_view line : lines) {
+    row.clear();
+    const char *p = line.data();
+    const char *end = line.data() + line.size();
+    while (p < end) {
+      int num;
+      const auto [next, ec] = std::from_chars(p, end, num);
+      if (ec == std::errc()) {
+        row.push_back(num);
+        p = next;
+      } else {
+        p++;
+      }
     }
 
     if (!row.empty()) {
-      levels.push_back(row);
+      co_yield row;
     }
   }
-
-  file.close();
-  return levels;
 }
 
-bool is_safe(const std::vector<int> &report) {
+// Reports are short, so the part 2 candidates fit in a small_vector.
+using Candidate = small_vector<int, 16>;
+
+template <typename Report> bool is_safe(const Report &report) {
   if (report.size() < 2) {
     return true;
   }
@@ -62,7 +69,7 @@ bool is_safe_part_2(const std::vector<int> &report) {
 
   for (size_t i = 0; i < report.size(); i++) {
 
-    std::vector<int> newArr;
+    Candidate newArr;
 
     for (size_t j = 0; j < report.size(); j++) {
 
@@ -79,36 +86,55 @@ bool is_safe_part_2(const std::vector<int> &report) {
   return false;
 }
 
-void day02_part1() {
-  auto levels = read_levels(FILE_NAME);
-  if (levels.empty()) {
-    return;
-  }
-
+// Solver stage. Returns -1 if the input held no reports.
+template <typename Predicate>
+int count_safe_reports(Generator<std::vector<int>> reports, Predicate safe) {
+  int total = 0;
   int safe_reports = 0;
-  for (const auto &row : levels) {
-    if (is_safe(row)) {
+  for (const auto &row : reports) {
+    total++;
+    if (safe(row)) {
       safe_reports++;
     }
   }
+  return total ? safe_reports : -1;
+}
 
-  std::cout << "Number of safe reports: " << safe_reports << std::endl;
+} // namespace
+
+void day02_part1() {
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME.c_str())) {
+    std::cout << "Number of safe reports: " << day02_part1_precomputed()
+              << '\n';
+    return;
+  }
+#endif
+  int safe_reports = count_safe_reports(
+      parse_reports(split_lines(read_chunks(FILE_NAME))),
+      is_safe<std::vector<int>>);
+  if (safe_reports < 0) {
+    return;
+  }
+
+  std::cout << "Number of safe reports: " << safe_reports << '\n';
 }
 
 void day02_part2() {
-  std::cout << "Day 2 Part 2 Solution: " << std::endl;
-
-  auto levels = read_levels(FILE_NAME);
-  if (levels.empty()) {
+  std::cout << "Day 2 Part 2 Solution: " << '\n';
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME.c_str())) {
+    std::cout << "Number of safe reports: " << day02_part2_precomputed()
+              << '\n';
     return;
   }
+#endif
 
-  int safe_reports = 0;
-  for (const auto &row : levels) {
-    if (is_safe_part_2(row)) {
-      safe_reports++;
-    }
+  int safe_reports = count_safe_reports(
+      parse_reports(split_lines(read_chunks(FILE_NAME))), is_safe_part_2);
+  if (safe_reports < 0) {
+    return;
   }
 
-  std::cout << "Number of safe reports: " << safe_reports << std::endl;
+  std::cout << "Number of safe reports: " << safe_reports << '\n';
 }
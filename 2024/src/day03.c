@@ -1,4 +1,5 @@
 #include "day03.h"
+#include "input.h"
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -83,7 +84,7 @@ static char *read_line(FILE *file) {
 }
 
 void day03_part1() {
-  FILE *file = fopen(FILE_NAME, "r");
+  FILE *file = aoc_open_input(FILE_NAME);
   if (!file) {
     fprintf(stderr, "Failed to open file: %s\n", FILE_NAME);
     return;
@@ -114,7 +115,7 @@ void day03_part1() {
 }
 
 void day03_part2() {
-  FILE *file = fopen(FILE_NAME, "r");
+  FILE *file = aoc_open_input(FILE_NAME);
   if (!file) {
     fprintf(stderr, "Failed to open file: %s\n", FILE_NAME);
     return;
@@ -1,13 +1,18 @@
 #include "day04.h"
-#include <fstream>
+#include "input.h"
+#include <array>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-static const std::string FILE_NAME = "../inputs/day04.txt";
+namespace {
+
+const std::string FILE_NAME = "../inputs/day04.txt";
 
 std::vector<std::string> read_words(const std::string &fileName) {
-  std::ifstream file(fileName);
+  InputStream file(fileName);
   std::vector<std::string> words;
 
   if (!file.is_open()) {
@@ -66,6 +71,11 @@ int countXmas(const std::vector<std::string> &grid) {
   return count;
 }
 
+// Readings of the two diagonals through an 'A' that spell an X-MAS.
+constexpr std::array<std::pair<std::string_view, std::string_view>, 4>
+    VALID_COMBOS = {{{"MAS", "MAS"}, {"MAS", "SAM"}, {"SAM", "MAS"},
+                     {"SAM", "SAM"}}};
+
 int countXmasPart2(const std::vector<std::string> &grid) {
   if (grid.empty()) {
     return 0;
@@ -83,10 +93,7 @@ int countXmasPart2(const std::vector<std::string> &grid) {
     for (int j = 0; j < cols; j++) {
       if (grid[i][j] == 'A') {
 
-        const std::vector<std::pair<std::string, std::string>> validCombos = {
-            {"MAS", "MAS"}, {"MAS", "SAM"}, {"SAM", "MAS"}, {"SAM", "SAM"}};
-
-        for (const auto &[pattern1, pattern2] : validCombos) {
+        for (const auto &[pattern1, pattern2] : VALID_COMBOS) {
           bool match = true;
 
           // Check first diagonal (top-left to bottom-right)
@@ -112,17 +119,19 @@ int countXmasPart2(const std::vector<std::string> &grid) {
   return count;
 }
 
+} // namespace
+
 void day04_part1() {
   std::vector<std::string> grid = read_words(FILE_NAME);
   int number_of_xmas_occurrences = countXmas(grid);
   std::cout << "Number of occurrences: " << number_of_xmas_occurrences
-            << std::endl;
+            << '\n';
 }
 
 void day04_part2() {
   std::vector<std::string> grid = read_words(FILE_NAME);
   int number_of_xmas_occurrences = countXmasPart2(grid);
   std::cout << "Number of occurrences: " << number_of_xmas_occurrences
-            << std::endl;
+            << '\n';
 }
 
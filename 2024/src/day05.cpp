@@ -1,6 +1,7 @@
 #include "day05.h"
+#include "constexpr_solve.h"
+#include "input.h"
 #include <algorithm>
-#include <fstream>
 #include <iostream>
 #include <set>
 #include <span>
@@ -55,7 +56,7 @@ struct InputData {
 
   static InputData parse(const std::string &filename) {
     InputData data;
-    std::ifstream file(filename);
+    InputStream file(filename);
     std::string line;
     bool parsingRules = true;
 
@@ -79,6 +80,13 @@ struct InputData {
 } // namespace
 
 void day05_part1() {
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME.data())) {
+    std::cout << "Sum of Middle Elements Part 1: " << day05_part1_precomputed()
+              << '\n';
+    return;
+  }
+#endif
   const auto data = InputData::parse(std::string(FILE_NAME));
   int sum = 0;
 
@@ -92,6 +100,13 @@ void day05_part1() {
 }
 
 void day05_part2() {
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed(FILE_NAME.data())) {
+    std::cout << "Sum of middle elements in corrected sequences Part 2: "
+              << day05_part2_precomputed() << '\n';
+    return;
+  }
+#endif
   const auto data = InputData::parse(std::string(FILE_NAME));
   int sum = 0;
 
@@ -1,4 +1,7 @@
 #include "day06.h"
+#include "input.h"
+#include "log.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -159,7 +162,7 @@ static void print_lab_state(Lab *lab) {
 
 void day06_part1() {
 
-  FILE *file = fopen(FILE_NAME, "r");
+  FILE *file = aoc_open_input(FILE_NAME);
 
   if (!file) {
     printf("File failed to open:\n");
@@ -172,7 +175,7 @@ void day06_part1() {
 
   while ((line = read_line(file))) {
     rows++;
-    printf("Line find dims: %s\n", line);
+    AOC_TRACE("Line find dims: %s\n", line);
 
     if (strlen(line) > cols) {
       cols = strlen(line);
@@ -193,7 +196,7 @@ void day06_part1() {
 
   while ((line = read_line(file))) {
 
-    printf("Line reading data: %s\n", line);
+    AOC_TRACE("Line reading data: %s\n", line);
 
     strcpy(lab.map[row], line);
     row++;
@@ -222,6 +225,13 @@ void day06_part1() {
   free_lab(&lab);
 }
 
+static void record_loop_steps(int steps) {
+  AOC_STAT_ADD("day06.candidates", 1);
+  AOC_STAT_ADD("day06.loop_steps", steps);
+  AOC_STAT_MAX("day06.max_loop_steps", steps);
+  (void)steps;
+}
+
 static bool detect_loop(Lab *lab) {
   typedef struct {
     bool up, right, down, left;
@@ -254,6 +264,7 @@ static bool detect_loop(Lab *lab) {
   while (true) {
     if (!move_guard(lab)) {
       // Guard left the map
+      record_loop_steps(steps);
       for (int i = 0; i < lab->rows; i++)
         free(visited[i]);
       free(visited);
@@ -289,6 +300,7 @@ static bool detect_loop(Lab *lab) {
 
     if (already_visited) {
       // We've been here in this direction before - it's a loop
+      record_loop_steps(steps);
       for (int i = 0; i < lab->rows; i++)
         free(visited[i]);
       free(visited);
@@ -328,7 +340,7 @@ static bool test_obstacle_position(Lab *lab, int x, int y) {
 
 void day06_part2() {
 
-  FILE *file = fopen(FILE_NAME, "r");
+  FILE *file = aoc_open_input(FILE_NAME);
 
   if (!file) {
     printf("File failed to open:\n");
@@ -341,7 +353,7 @@ void day06_part2() {
 
   while ((line = read_line(file))) {
     rows++;
-    printf("Line find dims: %s\n", line);
+    AOC_TRACE("Line find dims: %s\n", line);
 
     if (strlen(line) > cols) {
       cols = strlen(line);
@@ -362,7 +374,7 @@ void day06_part2() {
 
   while ((line = read_line(file))) {
 
-    printf("Line reading data: %s\n", line);
+    AOC_TRACE("Line reading data: %s\n", line);
 
     strcpy(lab.map[row], line);
     row++;
@@ -1,4 +1,6 @@
 #include "day07.h"
+#include "engine.h"
+#include "input.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,13 +8,19 @@
 #define FILE_NAME "../inputs/day07.txt"
 #define MAX_LINE_LENGTH 1024
 
+typedef int (*Solvable)(long long target, const long long *numbers, int count,
+                        char *operators, int pos);
+
 // Helper function prototypes
 static long long concatenate(long long a, long long b);
-static Equation *read_equations(const char *file_name, int *num_equations);
+static int read_equation(FILE *file, Equation *eq, int *capacity);
+static long long sum_solvable(const char *file_name, Solvable solvable);
 static long long evaluate(const long long *numbers, int count, const char *operators);
 static int try_combinations(long long target, const long long *numbers, int count, char *operators, int pos);
 static int try_combinations_part_2(long long target, const long long *numbers, int count, char *operators, int pos);
-static void free_equations(Equation *equations, int num_equations);
+static int can_reach(long long target, const long long *numbers, int count, int with_concat);
+static int reach_add_mul(long long target, const long long *numbers, int count, char *operators, int pos);
+static int reach_with_concat(long long target, const long long *numbers, int count, char *operators, int pos);
 
 static long long concatenate(long long a, long long b) {
     long long temp = b;
@@ -26,74 +34,78 @@ static long long concatenate(long long a, long long b) {
     return a * multiplier + b;
 }
 
-static Equation *read_equations(const char *file_name, int *num_equations) {
-    FILE *file = fopen(file_name, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Could not open file %s\n", file_name);
-        return NULL;
-    }
-
-    Equation *equations = NULL;
-    *num_equations = 0;
+// Reads the next equation, reusing eq->numbers (grown as needed, capacity in
+// *capacity), so only one equation is in memory at a time. Returns 0 at end
+// of input or on allocation failure.
+static int read_equation(FILE *file, Equation *eq, int *capacity) {
     char line[MAX_LINE_LENGTH];
 
     while (fgets(line, sizeof(line), file)) {
-        Equation *new_eq = realloc(equations, (*num_equations + 1) * sizeof(Equation));
-        if (!new_eq) {
-            fprintf(stderr, "Error: Memory allocation failed\n");
-            free_equations(equations, *num_equations);
-            fclose(file);
-            return NULL;
-        }
-        equations = new_eq;
-
-        char *token = strtok(line, ":");
+        char *save = NULL;
+        char *token = strtok_r(line, ":", &save);
         if (!token) continue;
 
-        equations[*num_equations].target = atoll(token);
-        char *rest = strtok(NULL, "\n");
+        eq->target = atoll(token);
+        char *rest = strtok_r(NULL, "\n", &save);
         if (!rest) continue;
 
-        // Count numbers first
-        int count = 0;
-        char *temp_str = strdup(rest);
-        if (!temp_str) {
-            fprintf(stderr, "Error: Memory allocation failed\n");
-            free_equations(equations, *num_equations);
-            fclose(file);
-            return NULL;
-        }
-
-        token = strtok(temp_str, " ");
+        eq->count = 0;
+        token = strtok_r(rest, " ", &save);
         while (token) {
-            if (*token) count++;
-            token = strtok(NULL, " ");
-        }
-        free(temp_str);
-
-        // Allocate and store numbers
-        equations[*num_equations].numbers = malloc(count * sizeof(long long));
-        if (!equations[*num_equations].numbers) {
-            fprintf(stderr, "Error: Memory allocation failed\n");
-            free_equations(equations, *num_equations);
-            fclose(file);
-            return NULL;
-        }
-
-        equations[*num_equations].count = count;
-        token = strtok(rest, " ");
-        for (int i = 0; i < count && token; i++) {
             if (*token) {
-                equations[*num_equations].numbers[i] = atoll(token);
+                if (eq->count == *capacity) {
+                    int new_capacity = *capacity ? *capacity * 2 : 16;
+                    long long *numbers = realloc(eq->numbers, new_capacity * sizeof(long long));
+                    if (!numbers) {
+                        fprintf(stderr, "Error: Memory allocation failed\n");
+                        return 0;
+                    }
+                    eq->numbers = numbers;
+                    *capacity = new_capacity;
+                }
+                eq->numbers[eq->count++] = atoll(token);
             }
-            token = strtok(NULL, " ");
+            token = strtok_r(NULL, " ", &save);
         }
+        return 1;
+    }
+    return 0;
+}
 
-        (*num_equations)++;
+// Streams the equations in file_name through `solvable` and sums the
+// targets of those it accepts. Returns -1 if the file cannot be read.
+static long long sum_solvable(const char *file_name, Solvable solvable) {
+    FILE *file = aoc_open_input(file_name);
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s\n", file_name);
+        return -1;
+    }
+
+    Equation eq = {0, NULL, 0};
+    int capacity = 0;
+    char *operators = NULL;
+    long long sum = 0;
+
+    while (read_equation(file, &eq, &capacity)) {
+        if (eq.count > 1) {
+            char *ops = realloc(operators, eq.count - 1);
+            if (!ops) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                sum = -1;
+                break;
+            }
+            operators = ops;
+
+            if (solvable(eq.target, eq.numbers, eq.count, operators, 0)) {
+                sum += eq.target;
+            }
+        }
     }
 
+    free(operators);
+    free(eq.numbers);
     fclose(file);
-    return equations;
+    return sum;
 }
 
 static long long evaluate(const long long *numbers, int count, const char *operators) {
@@ -148,72 +160,70 @@ static int try_combinations_part_2(long long target, const long long *numbers, i
     return 0;
 }
 
-static void free_equations(Equation *equations, int num_equations) {
-    if (!equations) return;
-    
-    for (int i = 0; i < num_equations; i++) {
-        free(equations[i].numbers);
+// Fast engine: undoes the operators from the right. The last number can
+// only have been added if it is <= target, multiplied if it divides target,
+// and concatenated if target ends in its digits, which prunes almost every
+// branch the forward search would expand.
+static int can_reach(long long target, const long long *numbers, int count,
+                     int with_concat) {
+    long long last = numbers[count - 1];
+    if (count == 1) {
+        return target == last;
+    }
+    if (target < 0) {
+        return 0;
     }
-    free(equations);
+
+    if (with_concat && target >= last) {
+        long long multiplier = concatenate(1, last) - last;
+        if ((target - last) % multiplier == 0 &&
+            can_reach((target - last) / multiplier, numbers, count - 1, with_concat)) {
+            return 1;
+        }
+    }
+    if (last == 0 ? target == 0 : target % last == 0) {
+        if (last == 0 || can_reach(target / last, numbers, count - 1, with_concat)) {
+            return 1;
+        }
+    }
+    return target >= last &&
+           can_reach(target - last, numbers, count - 1, with_concat);
+}
+
+static int reach_add_mul(long long target, const long long *numbers, int count,
+                         char *operators, int pos) {
+    (void)operators;
+    (void)pos;
+    return can_reach(target, numbers, count, 0);
+}
+
+static int reach_with_concat(long long target, const long long *numbers, int count,
+                             char *operators, int pos) {
+    (void)operators;
+    (void)pos;
+    return can_reach(target, numbers, count, 1);
 }
 
 void day07_part1(void) {
-    int num_equations;
-    Equation *equations = read_equations(FILE_NAME, &num_equations);
-    if (!equations) {
+    long long sum = sum_solvable(FILE_NAME, aoc_engine == AOC_ENGINE_REFERENCE
+                                                ? try_combinations
+                                                : reach_add_mul);
+    if (sum < 0) {
         fprintf(stderr, "Error: Failed to read equations\n");
         return;
     }
 
-    long long sum = 0;
-    for (int i = 0; i < num_equations; i++) {
-        if (equations[i].count > 1) {
-            char *operators = calloc(equations[i].count - 1, sizeof(char));
-            if (!operators) {
-                fprintf(stderr, "Error: Memory allocation failed\n");
-                free_equations(equations, num_equations);
-                return;
-            }
-
-            if (try_combinations(equations[i].target, equations[i].numbers,
-                               equations[i].count, operators, 0)) {
-                sum += equations[i].target;
-            }
-            free(operators);
-        }
-    }
-
     printf("Part 1 Sum: %lld\n", sum);
-    free_equations(equations, num_equations);
 }
 
 void day07_part2(void) {
-    int num_equations;
-    Equation *equations = read_equations(FILE_NAME, &num_equations);
-    if (!equations) {
+    long long sum = sum_solvable(FILE_NAME, aoc_engine == AOC_ENGINE_REFERENCE
+                                                ? try_combinations_part_2
+                                                : reach_with_concat);
+    if (sum < 0) {
         fprintf(stderr, "Error: Failed to read equations\n");
         return;
     }
 
-    long long sum = 0;
-    for (int i = 0; i < num_equations; i++) {
-        if (equations[i].count > 1) {
-            char *operators = calloc(equations[i].count - 1, sizeof(char));
-            if (!operators) {
-                fprintf(stderr, "Error: Memory allocation failed\n");
-                free_equations(equations, num_equations);
-                return;
-            }
-
-            if (try_combinations_part_2(equations[i].target, equations[i].numbers,
-                                      equations[i].count, operators, 0)) {
-                sum += equations[i].target;
-            }
-            free(operators);
-        }
-    }
-
     printf("Part 2 Sum: %lld\n", sum);
-    free_equations(equations, num_equations);
 }
-
@@ -1,164 +1,194 @@
 #include "day08.h"
+#include "grid.h"
+#include "input.h"
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <cctype>
 #include <iostream>
+#include <numeric>
 #include <omp.h>
-#include <ranges>
-#include <set>
 #include <span>
+#include <string>
 #include <string_view>
-#include <thread>
+#include <vector>
 
 namespace {
-constexpr std::string_view FILE_NAME = "../inputs/day08.txt";
+struct Antenna {
+  int x, y;
+  char freq;
+};
 
-[[nodiscard]] constexpr bool is_in_bounds(const Point &p, int width,
-                                          int height) noexcept {
-  return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
-}
-} // namespace
+struct Point {
+  int x, y;
+};
 
-[[nodiscard]] std::vector<std::string>
-parse_input(const std::string_view &file_name) {
-  std::vector<std::string> map;
+constexpr std::string_view FILE_NAME = "../inputs/day08.txt";
+
+// Only the antennas are kept: on a large map that is mostly '.', the text
+// itself would be the biggest allocation in the solver.
+[[nodiscard]] std::vector<Antenna>
+read_antennas(const std::string_view &file_name, int &width, int &height) {
+  std::vector<Antenna> antennas;
+  width = 0;
+  height = 0;
 
-  std::string filename(file_name);
-  std::ifstream file;
-  file.open(filename);
+  InputStream file(file_name);
 
   if (!file.is_open()) {
-    return map;
+    return antennas;
   }
 
   std::string line;
   while (std::getline(file, line)) {
-    if (!line.empty()) {
-      map.emplace_back(std::move(line));
+    if (line.empty()) {
+      continue;
     }
+    for (int x = 0; x < static_cast<int>(line.size()); ++x) {
+      if (std::isalnum(static_cast<unsigned char>(line[x]))) {
+        antennas.push_back({x, height, line[x]});
+      }
+    }
+    width = std::max(width, static_cast<int>(line.size()));
+    ++height;
   }
 
-  return map;
+  return antennas;
 }
 
-[[nodiscard]] std::vector<Point>
-find_antinodes(std::span<const Antenna> antennas, int width, int height) {
-  std::set<Point> antinodes;
-
-  // Use parallel execution for larger datasets
-  std::for_each(
-      antennas.begin(), antennas.end() - 1, [=, &antinodes](const auto &ant1) {
-        for (const auto &ant2 :
-             std::span(antennas).subspan(&ant1 - antennas.data() + 1)) {
-          if (ant1.freq != ant2.freq)
-            continue;
-
-          const auto [dx, dy] = std::tuple{ant2.x - ant1.x, ant2.y - ant1.y};
-          const Point antinode1{ant1.x - dx, ant1.y - dy};
-          const Point antinode2{ant2.x + dx, ant2.y + dy};
-
-#pragma omp critical
-          {
-            if (is_in_bounds(antinode1, width, height))
-              antinodes.insert(antinode1);
-            if (is_in_bounds(antinode2, width, height))
-              antinodes.insert(antinode2);
-          }
-        }
-      });
+// Antenna pairs sharing a frequency; each contributes antinodes.
+[[nodiscard]] std::size_t count_pairs(std::span<const Antenna> antennas) {
+  std::array<std::size_t, 256> per_freq{};
+  for (const auto &antenna : antennas) {
+    per_freq[static_cast<unsigned char>(antenna.freq)]++;
+  }
+  std::size_t pairs = 0;
+  for (const std::size_t n : per_freq) {
+    pairs += n * (n - 1) / 2;
+  }
+  return pairs;
+}
+
+// Sets each in-bounds point in `antinodes` and returns how many were not
+// set before.
+template <typename Cells>
+std::size_t mark(Cells &antinodes, std::span<const Point> points) {
+  std::size_t added = 0;
+  for (const Point &p : points) {
+    if (antinodes.in_bounds(p.y, p.x)) {
+      char &cell = antinodes.at(p.y, p.x);
+      added += !cell;
+      cell = 1;
+    }
+  }
+  return added;
+}
 
-  return {antinodes.begin(), antinodes.end()};
+template <typename Shape>
+[[nodiscard]] std::size_t count_antinodes(std::span<const Antenna> antennas,
+                                          int width, int height) {
+  ShapedGrid<char, Shape> antinodes(height, width, 0);
+  std::size_t count = 0;
+
+  for (std::size_t i = 0; i < antennas.size(); ++i) {
+    for (std::size_t j = i + 1; j < antennas.size(); ++j) {
+      const Antenna &ant1 = antennas[i];
+      const Antenna &ant2 = antennas[j];
+      if (ant1.freq != ant2.freq)
+        continue;
+
+      const int dx = ant2.x - ant1.x;
+      const int dy = ant2.y - ant1.y;
+      const Point found[] = {{ant1.x - dx, ant1.y - dy},
+                             {ant2.x + dx, ant2.y + dy}};
+      count += mark(antinodes, found);
+    }
+  }
+
+  return count;
 }
+} // namespace
 
 void day08_part1() {
-  const auto map = parse_input(FILE_NAME);
-  if (map.empty()) {
+  int width = 0;
+  int height = 0;
+  const auto antennas = read_antennas(FILE_NAME, width, height);
+  if (height == 0) {
     std::cout << "Map is empty.\n";
     return;
   }
 
-  const auto [height, width] =
-      std::tuple{static_cast<int>(map.size()), static_cast<int>(map[0].size())};
-
-  std::vector<Antenna> antennas;
-  antennas.reserve(width * height / 4); // Estimate antenna density
+  const std::size_t count = dispatch_grid_density(
+      height, width, 2 * count_pairs(antennas), [&](auto shape) {
+        return count_antinodes<decltype(shape)>(antennas, width, height);
+      });
+  std::cout << "Number of unique antinode locations: " << count << '\n';
+}
 
-  for (int y = 0; y < height; ++y) {
-    for (int x = 0; x < width; ++x) {
-      if (std::isalnum(map[y][x])) {
-        antennas.push_back({x, y, map[y][x]});
-      }
+namespace {
+// Every grid point on the line through two same-frequency antennas: walk
+// it both ways from ant1 in steps of the reduced direction.
+void line_points(const Antenna &ant1, const Antenna &ant2, int width,
+                 int height, std::vector<Point> &out) {
+  const int dx = ant2.x - ant1.x;
+  const int dy = ant2.y - ant1.y;
+  const int g = std::gcd(dx, dy);
+  for (const int sign : {1, -1}) {
+    const int step_x = sign * dx / g;
+    const int step_y = sign * dy / g;
+    int x = sign > 0 ? ant1.x : ant1.x + step_x;
+    int y = sign > 0 ? ant1.y : ant1.y + step_y;
+    for (; x >= 0 && x < width && y >= 0 && y < height;
+         x += step_x, y += step_y) {
+      out.push_back({x, y});
     }
   }
-
-  const auto antinodes = find_antinodes(antennas, width, height);
-  std::cout << "Number of unique antinode locations: " << antinodes.size()
-            << '\n';
 }
 
-[[nodiscard]] constexpr bool is_collinear(const Antenna &a1, const Antenna &a2,
-                                          const Point &p) noexcept {
-  return (p.y - a1.y) * (a2.x - a1.x) == (a2.y - a1.y) * (p.x - a1.x);
-}
-
-[[nodiscard]] std::vector<Point>
-find_antinodes_part2(std::span<const Antenna> antennas, int width, int height) {
-  std::set<Point> antinodes;
-  const auto num_threads = std::thread::hardware_concurrency();
-  std::vector<std::set<Point>> thread_antinodes(num_threads);
-
-#pragma omp parallel for collapse(2) num_threads(num_threads)
-  for (int y = 0; y < height; ++y) {
-    for (int x = 0; x < width; ++x) {
-      const Point p{x, y};
-      const auto thread_id = omp_get_thread_num();
-
-      auto &local_antinodes = thread_antinodes[thread_id];
-
-      for (const auto &ant1 : antennas) {
-        for (const auto &ant2 : antennas) {
-          if (&ant1 >= &ant2 || ant1.freq != ant2.freq)
-            continue;
-
-          if (is_collinear(ant1, ant2, p)) {
-            local_antinodes.insert(p);
-            goto next_point;
-          }
-        }
+template <typename Shape>
+[[nodiscard]] std::size_t
+count_antinodes_part2(std::span<const Antenna> antennas, int width,
+                      int height) {
+  // Follow the OpenMP team size so callers can sweep it with
+  // omp_set_num_threads().
+  const auto num_threads = omp_get_max_threads();
+  std::vector<std::vector<Point>> thread_points(num_threads);
+
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (std::size_t i = 0; i < antennas.size(); ++i) {
+    auto &local_points = thread_points[omp_get_thread_num()];
+    for (std::size_t j = i + 1; j < antennas.size(); ++j) {
+      if (antennas[i].freq == antennas[j].freq) {
+        line_points(antennas[i], antennas[j], width, height, local_points);
       }
-    next_point:;
     }
   }
 
   // Merge thread-local results
-  for (const auto &local_set : thread_antinodes) {
-    antinodes.merge(std::set<Point>(local_set));
+  ShapedGrid<char, Shape> antinodes(height, width, 0);
+  std::size_t count = 0;
+  for (const auto &local_points : thread_points) {
+    count += mark(antinodes, local_points);
   }
-
-  return {antinodes.begin(), antinodes.end()};
+  return count;
 }
+} // namespace
 
 void day08_part2() {
-  const auto map = parse_input(FILE_NAME);
-  if (map.empty()) {
+  int width = 0;
+  int height = 0;
+  const auto antennas = read_antennas(FILE_NAME, width, height);
+  if (height == 0) {
     std::cout << "Map is empty.\n";
     return;
   }
 
-  const auto [height, width] =
-      std::tuple{static_cast<int>(map.size()), static_cast<int>(map[0].size())};
-
-  std::vector<Antenna> antennas;
-  antennas.reserve(width * height / 4);
-
-  for (int y = 0; y < height; ++y) {
-    for (int x = 0; x < width; ++x) {
-      if (std::isalnum(map[y][x])) {
-        antennas.push_back({x, y, map[y][x]});
-      }
-    }
-  }
-
-  const auto antinodes = find_antinodes_part2(antennas, width, height);
-  std::cout << "Number of unique antinode locations (Part 2): "
-            << antinodes.size() << '\n';
+  // A line can cross the whole map.
+  const std::size_t expected =
+      count_pairs(antennas) * static_cast<std::size_t>(std::max(width, height));
+  const std::size_t count =
+      dispatch_grid_density(height, width, expected, [&](auto shape) {
+        return count_antinodes_part2<decltype(shape)>(antennas, width, height);
+      });
+  std::cout << "Number of unique antinode locations (Part 2): " << count
+            << '\n';
 }
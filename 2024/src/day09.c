@@ -1,12 +1,13 @@
 #include "day09.h"
+#include "input.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define FILE_NAME "../inputs/day09.txt"
 
-char* read_input_file(const char* filename) {
-    FILE* fp = fopen(filename, "r");
+static char* read_input_file(const char* filename) {
+    FILE* fp = aoc_open_input(filename);
     if (!fp) {
         perror("Failed to open file");
         return NULL;
@@ -24,7 +25,7 @@ char* read_input_file(const char* filename) {
     return input;
 }
 
-Disk* uncompress(const char* input) {
+static Disk* uncompress(const char* input) {
     Disk* disk = malloc(sizeof(Disk));
     int total_len = 0;
     
@@ -58,7 +59,7 @@ Disk* uncompress(const char* input) {
     return disk;
 }
 
-void move_to_start(Disk* disk) {
+static void move_to_start(Disk* disk) {
     int left = 0;
     int right = disk->length - 1;
     
@@ -83,7 +84,7 @@ void move_to_start(Disk* disk) {
     }
 }
 
-long calculate_checksum(Disk* disk) {
+static long calculate_checksum(Disk* disk) {
     long sum = 0;
     for (int i = 0; i < disk->length; i++) {
         if (disk->blocks[i] != -1) {
@@ -93,7 +94,7 @@ long calculate_checksum(Disk* disk) {
     return sum;
 }
 
-void move_files_to_start(Disk* disk) {
+static void move_files_to_start(Disk* disk) {
     for (int file_id = (disk->length - 1) / 2; file_id >= 0; file_id--) {
         int file_length = 0;
         int file_start = -1;
@@ -1,24 +1,26 @@
 #include "day11.h"
-#include <fstream>
+#include "input.h"
+#include "stats.h"
 #include <iostream>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-static constexpr const char *FILE_NAME = "../inputs/day11.txt";
+namespace {
 
-using Cache = std::unordered_map<std::pair<long long, int>, long long>;
+constexpr const char *FILE_NAME = "../inputs/day11.txt";
 
-namespace std {
-template <> struct hash<std::pair<long long, int>> {
+struct StoneHash {
   size_t operator()(const std::pair<long long, int> &p) const {
     return std::hash<long long>()(p.first) ^ std::hash<int>()(p.second);
   }
 };
-} // namespace std
 
-static std::vector<long long> read_input_file(const std::string &file_name) {
-  std::ifstream file(file_name);
+using Cache =
+    std::unordered_map<std::pair<long long, int>, long long, StoneHash>;
+
+std::vector<long long> read_input_file(const std::string &file_name) {
+  InputStream file(file_name);
   if (!file) {
     throw std::runtime_error("Failed to open file.");
   }
@@ -30,7 +32,7 @@ static std::vector<long long> read_input_file(const std::string &file_name) {
   return numbers;
 }
 
-static long long process_blinks(long long stone, int blinks, Cache &memory) {
+long long process_blinks(long long stone, int blinks, Cache &memory) {
   if (blinks == 0) {
     return 1;
   }
@@ -38,8 +40,10 @@ static long long process_blinks(long long stone, int blinks, Cache &memory) {
   std::pair<long long, int> key = std::make_pair(stone, blinks);
 
   if (auto it = memory.find(key); it != memory.end()) {
+    AOC_STAT_ADD("day11.memo_hits", 1);
     return it->second;
   }
+  AOC_STAT_ADD("day11.memo_misses", 1);
 
   long long result;
   if (stone == 0) {
@@ -61,6 +65,8 @@ static long long process_blinks(long long stone, int blinks, Cache &memory) {
   return result;
 }
 
+} // namespace
+
 void day11_part1(void) {
   std::vector<long long> numbers = read_input_file(FILE_NAME);
   Cache memory;
@@ -68,7 +74,7 @@ void day11_part1(void) {
   for (auto stone : numbers) {
     total += process_blinks(stone, 25, memory);
   }
-  std::cout << "Number of stones after 25 blinks: " << total << std::endl;
+  std::cout << "Number of stones after 25 blinks: " << total << '\n';
 }
 
 void day11_part2(void) {
@@ -78,5 +84,5 @@ void day11_part2(void) {
   for (auto stone : numbers) {
     total += process_blinks(stone, 75, memory);
   }
-  std::cout << "Number of stones after 75 blinks: " << total << std::endl;
+  std::cout << "Number of stones after 75 blinks: " << total << '\n';
 }
@@ -1,6 +1,8 @@
 #include "day12.h"
+#include "grid.h"
+#include "input.h"
+#include "log.h"
 #include <algorithm>
-#include <fstream>
 #include <iostream>
 #include <ostream>
 #include <set>
@@ -11,6 +13,8 @@
 
 #define FILE_NAME "../inputs/day12.txt"
 
+namespace {
+
 const int dx[] = {0, 0, -1, 1};
 const int dy[] = {1, -1, 0, 0};
 
@@ -21,67 +25,54 @@ struct PairHash {
     }
 };
 
-std::vector<std::vector<char>>
-read_input_day_12(const std::string_view &file_name) {
-    std::vector<std::vector<char>> grid;
-    std::ifstream file(file_name.data());
+std::vector<std::string> read_input_day_12(const std::string_view &file_name) {
+    std::vector<std::string> lines;
+    InputStream file(file_name);
     std::string line;
     while (std::getline(file, line)) {
         if (!line.empty()) {
-            grid.push_back(std::vector<char>(line.begin(), line.end()));
-        }
-    }
-    return grid;
-}
-
-void print_grid(const std::vector<std::vector<char>> &grid) {
-    for (const auto &row : grid) {
-        for (char cell : row) {
-            std::cout << cell;
+            lines.push_back(line);
         }
-        std::cout << '\n';
     }
+    return lines;
 }
 
-void dfs(const std::vector<std::vector<char>> &grid,
-         std::vector<std::vector<bool>> &visited, size_t row, size_t col,
-         char plant, size_t &area, size_t &perimeter) {
-    size_t rows = grid.size();
-    size_t cols = grid[0].size();
-    if (row >= rows || col >= cols || visited[row][col] ||
-        grid[row][col] != plant) {
-        return;
-    }
-    visited[row][col] = true;
-    area++;
-    for (int i = 0; i < 4; i++) {
-        const int new_row = row + dx[i];
-        const int new_col = col + dy[i];
-        if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols ||
-            grid[new_row][new_col] != plant) {
-            perimeter++;
-            continue;
-        }
-        if (!visited[new_row][new_col]) {
-            dfs(grid, visited, new_row, new_col, plant, area, perimeter);
+template <typename Cells>
+void print_grid(const Cells &grid) {
+    std::string row(grid.cols(), ' ');
+    for (int r = 0; r < grid.rows(); r++) {
+        for (int c = 0; c < grid.cols(); c++) {
+            row[c] = grid.at(r, c);
         }
+        aoc_log_printf("%s\n", row.c_str());
     }
 }
 
-void dfs_region(const std::vector<std::vector<char>>& grid,
-                std::vector<std::vector<bool>>& visited,
-                std::unordered_set<std::pair<int, int>, PairHash>& region,
-                int row, int col, char plant) {
-    if (row < 0 || row >= grid.size() || col < 0 || col >= grid[0].size() ||
-        visited[row][col] || grid[row][col] != plant) {
-        return;
-    }
-    
-    visited[row][col] = true;
-    region.insert({row, col});
-    
-    for (int i = 0; i < 4; ++i) {
-        dfs_region(grid, visited, region, row + dx[i], col + dy[i], plant);
+// Flood-fills the region containing (row, col) with an explicit stack, so
+// regions of millions of cells on large synthetic grids cannot overflow the
+// call stack. `visit` sees each cell of the region once, with the number of
+// its neighbours that belong to the region.
+template <typename Cells, typename Visit>
+void flood_region(const Cells &grid, Cells &visited, int row, int col,
+                  Visit &&visit) {
+    const char plant = grid.at(row, col);
+    std::vector<std::pair<int, int>> stack = {{row, col}};
+    visited.at(row, col) = true;
+    while (!stack.empty()) {
+        auto [r, c] = stack.back();
+        stack.pop_back();
+        int same = 0;
+        grid.for_each_neighbor(r, c, [&](int nr, int nc) {
+            if (grid.at(nr, nc) != plant) {
+                return;
+            }
+            same++;
+            if (!visited.at(nr, nc)) {
+                visited.at(nr, nc) = true;
+                stack.push_back({nr, nc});
+            }
+        });
+        visit(r, c, same);
     }
 }
 
@@ -113,54 +104,81 @@ size_t count_region_sides(const std::unordered_set<std::pair<int, int>, PairHash
     return side_count;
 }
 
-void day12_part1() {
-    const std::vector<std::vector<char>> grid = read_input_day_12(FILE_NAME);
-    if (grid.empty()) {
-        std::cout << "Failed to read grid." << std::endl;
-        return;
-    }
-    std::cout << "Grid contents:\n";
-    print_grid(grid);
-    size_t rows = grid.size();
-    size_t cols = grid[0].size();
-    std::vector<std::vector<bool>> visited(rows, std::vector<bool>(cols, false));
+template <typename Cells>
+size_t fence_price(const Cells &grid) {
+    Cells visited(grid.rows(), grid.cols(), false);
     size_t total_price = 0;
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < cols; j++) {
-            if (!visited[i][j]) {
+    for (int i = 0; i < grid.rows(); i++) {
+        for (int j = 0; j < grid.cols(); j++) {
+            if (!visited.at(i, j)) {
                 size_t area = 0;
                 size_t perimeter = 0;
-                dfs(grid, visited, i, j, grid[i][j], area, perimeter);
+                flood_region(grid, visited, i, j, [&](int, int, int same) {
+                    area++;
+                    perimeter += 4 - same;
+                });
                 total_price += area * perimeter;
             }
         }
     }
-    std::cout << "Total price: " << total_price << std::endl;
+    return total_price;
 }
 
-void day12_part2() {
-    const std::vector<std::vector<char>> grid = read_input_day_12(FILE_NAME);
-    if (grid.empty()) {
-        std::cout << "Failed to read grid." << std::endl;
-        return;
-    }
-    
-    size_t rows = grid.size();
-    size_t cols = grid[0].size();
-    std::vector<std::vector<bool>> visited(rows, std::vector<bool>(cols, false));
+template <typename Cells>
+size_t bulk_price(const Cells &grid) {
+    Cells visited(grid.rows(), grid.cols(), false);
     size_t total_price = 0;
-    
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < cols; j++) {
-            if (!visited[i][j]) {
+
+    for (int i = 0; i < grid.rows(); i++) {
+        for (int j = 0; j < grid.cols(); j++) {
+            if (!visited.at(i, j)) {
                 std::unordered_set<std::pair<int, int>, PairHash> region;
-                dfs_region(grid, visited, region, i, j, grid[i][j]);
+                flood_region(grid, visited, i, j, [&](int r, int c, int) {
+                    region.insert({r, c});
+                });
                 size_t sides = count_region_sides(region);
                 total_price += region.size() * sides;
             }
         }
     }
-    
-    std::cout << "Part 2 Total price: " << total_price << std::endl;
+    return total_price;
+}
+
+// Runs price(grid) on the input stored in the layout --grid-layout picks.
+template <typename Price>
+size_t with_grid(const std::vector<std::string> &lines, Price &&price) {
+    const int rows = static_cast<int>(lines.size());
+    const int cols = static_cast<int>(lines[0].size());
+    return dispatch_grid_shape<>(rows, cols, [&](auto shape) {
+        return price(make_char_grid<decltype(shape)>(lines));
+    });
+}
+
+} // namespace
+
+void day12_part1() {
+    const std::vector<std::string> lines = read_input_day_12(FILE_NAME);
+    if (lines.empty()) {
+        std::cout << "Failed to read grid." << '\n';
+        return;
+    }
+    const size_t total_price = with_grid(lines, [](const auto &grid) {
+        if (AOC_LOG_ENABLED(AOC_LOG_TRACE)) {
+            aoc_log_printf("Grid contents:\n");
+            print_grid(grid);
+        }
+        return fence_price(grid);
+    });
+    std::cout << "Total price: " << total_price << '\n';
 }
 
+void day12_part2() {
+    const std::vector<std::string> lines = read_input_day_12(FILE_NAME);
+    if (lines.empty()) {
+        std::cout << "Failed to read grid." << '\n';
+        return;
+    }
+    const size_t total_price = with_grid(
+        lines, [](const auto &grid) { return bulk_price(grid); });
+    std::cout << "Part 2 Total price: " << total_price << '\n';
+}
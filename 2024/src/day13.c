@@ -1,13 +1,23 @@
 #include "day13.h"
+#include "constexpr_solve.h"
+#include "engine.h"
+#include "input.h"
+#include "log.h"
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define MAX_PRESSES 100
+
+static long long solve_machine_part2(long long ax, long long ay, long long bx,
+                                     long long by, long long px, long long py);
+
+// Reference engine: tries every press count.
 static long long solve_machine(long long ax, long long ay, long long bx,
                                long long by, long long px, long long py) {
   // Try all combinations up to 100 presses (as per problem constraints)
-  for (int a = 0; a <= 100; a++) {
-    for (int b = 0; b <= 100; b++) {
+  for (int a = 0; a <= MAX_PRESSES; a++) {
+    for (int b = 0; b <= MAX_PRESSES; b++) {
       if ((a * ax + b * bx == px) && (a * ay + b * by == py)) {
         return (3 * a + b); // Cost: 3 tokens for A, 1 token for B
       }
@@ -16,8 +26,34 @@ static long long solve_machine(long long ax, long long ay, long long bx,
   return -1; // No solution found
 }
 
+// Fast engine: Cramer's rule, as in part 2, with the press limit applied.
+// Parallel buttons leave a line of solutions, so those fall back to the
+// search, which picks the same one the reference does.
+static long long solve_machine_fast(long long ax, long long ay, long long bx,
+                                    long long by, long long px, long long py) {
+  if (ax * by - ay * bx == 0) {
+    return solve_machine(ax, ay, bx, by, px, py);
+  }
+  long long tokens = solve_machine_part2(ax, ay, bx, by, px, py);
+  if (tokens < 0) {
+    return -1;
+  }
+  long long a = (px * by - py * bx) / (ax * by - ay * bx);
+  long long b = tokens - 3 * a;
+  if (a > MAX_PRESSES || b > MAX_PRESSES) {
+    return -1;
+  }
+  return tokens;
+}
+
 void day13_part1(void) {
-  FILE *file = fopen("../inputs/day13.txt", "r");
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed("../inputs/day13.txt")) {
+    printf("Part 1 - Total tokens needed: %lld\n", day13_part1_precomputed());
+    return;
+  }
+#endif
+  FILE *file = aoc_open_input("../inputs/day13.txt");
   if (!file) {
     printf("Error opening input file\n");
     return;
@@ -31,13 +67,15 @@ void day13_part1(void) {
                 "Button A: X+%lld, Y+%lld\nButton B: X+%lld, Y+%lld\nPrize: "
                 "X=%lld, Y=%lld\n",
                 &ax, &ay, &bx, &by, &px, &py) == 6) {
-    printf("Machine %d:\n", machine_count++);
-    printf("Button A: X+%lld, Y+%lld\n", ax, ay);
-    printf("Button B: X+%lld, Y+%lld\n", bx, by);
-    printf("Prize: X=%lld, Y=%lld\n", px, py);
+    AOC_DEBUG("Machine %d:\n", machine_count++);
+    AOC_DEBUG("Button A: X+%lld, Y+%lld\n", ax, ay);
+    AOC_DEBUG("Button B: X+%lld, Y+%lld\n", bx, by);
+    AOC_DEBUG("Prize: X=%lld, Y=%lld\n", px, py);
 
-    long long tokens = solve_machine(ax, ay, bx, by, px, py);
-    printf("Tokens needed: %lld\n\n", tokens);
+    long long tokens = aoc_engine == AOC_ENGINE_REFERENCE
+                           ? solve_machine(ax, ay, bx, by, px, py)
+                           : solve_machine_fast(ax, ay, bx, by, px, py);
+    AOC_DEBUG("Tokens needed: %lld\n\n", tokens);
 
     if (tokens >= 0) {
       total_tokens += tokens;
@@ -72,7 +110,13 @@ static long long solve_machine_part2(long long ax, long long ay, long long bx,
 }
 
 void day13_part2(void) {
-  FILE *file = fopen("../inputs/day13.txt", "r");
+#ifdef AOC_CONSTEXPR_SOLVE
+  if (aoc_use_precomputed("../inputs/day13.txt")) {
+    printf("Part 2 - Total tokens needed: %lld\n", day13_part2_precomputed());
+    return;
+  }
+#endif
+  FILE *file = aoc_open_input("../inputs/day13.txt");
   if (!file) {
     printf("Error opening input file\n");
     return;
@@ -90,9 +134,9 @@ void day13_part2(void) {
     px += OFFSET;
     py += OFFSET;
 
-    printf("Machine %d with offset:\n", machine_count++);
+    AOC_DEBUG("Machine %d with offset:\n", machine_count++);
     long long tokens = solve_machine_part2(ax, ay, bx, by, px, py);
-    printf("Tokens needed: %lld\n\n", tokens);
+    AOC_DEBUG("Tokens needed: %lld\n\n", tokens);
 
     if (tokens >= 0) {
       total_tokens += tokens;
@@ -1,133 +1,154 @@
 #include "day14.h"
+#include "constexpr_solve.h"
+#include "input.h"
+#include <algorithm>
 #include <iostream>
 #include <array>
 #include <cstdio>
 #include <string>
 #include <chrono>
+#include <limits>
+#include <vector>
 
+// Size of the puzzle inputs' room, the only size solved: the input does
+// not say how large its room is, so the 11x7 example is not supported.
+// Being constants, they let the modular arithmetic divide by immediates.
 constexpr int WIDTH = 101;
 constexpr int HEIGHT = 103;
 constexpr int SECONDS = 100;
 constexpr const char* FILE_NAME = "../inputs/day14.txt";
 
+struct Robot {
+    int px, py, vx, vy;
+};
+
 static int positive_mod(int x, int m) {
     return x % m < 0 ? x % m + m : x % m;
 }
 
-void day14_part1() {
-      auto start = std::chrono::high_resolution_clock::now();
-
-    int px, py, vx, vy;
-    std::array<std::array<int, 2>, 2> count = {};
-    
-    FILE* fp = std::fopen(FILE_NAME, "r");
-    
-    int particle_count = 0;
-    while(std::fscanf(fp, "p=%d,%d v=%d,%d\n", &px, &py, &vx, &vy) == 4) {
-        
-        px = positive_mod((px + vx * SECONDS), WIDTH);
-        py = positive_mod((py + vy * SECONDS), HEIGHT);
-        
-        
-        if (px != WIDTH/2 && py != HEIGHT/2) {
-            int quadrant_x = px / (WIDTH/2 + 1);
-            int quadrant_y = py / (HEIGHT/2 + 1);
-            count[quadrant_x][quadrant_y]++;
-        } 
-  }
+static std::vector<Robot> read_robots() {
+    std::vector<Robot> robots;
+    FILE* fp = aoc_open_input(FILE_NAME);
+    Robot r;
+    while(std::fscanf(fp, "p=%d,%d v=%d,%d\n", &r.px, &r.py, &r.vx, &r.vy) == 4) {
+        robots.push_back(r);
+    }
     std::fclose(fp);
-    
-    
-    const int safety_factor = count[0][0] * count[0][1] * count[1][0] * count[1][1];
-    
-    std::cout << "Day 14 Part 1: Safety factor = " << safety_factor << '\n';
-  auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    std::cout << "Execution time: " << duration.count() << " microseconds\n";
-
+    return robots;
 }
 
+static int safety_factor(const std::vector<Robot>& robots) {
+    constexpr int width = WIDTH;
+    constexpr int height = HEIGHT;
+    std::array<std::array<int, 2>, 2> count = {};
+    for (const Robot& r : robots) {
+        const int px = positive_mod((r.px + r.vx * SECONDS), width);
+        const int py = positive_mod((r.py + r.vy * SECONDS), height);
 
-
-
-void day14_part2() {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    std::vector<std::pair<int, int>> positions;
-    std::vector<std::pair<int, int>> velocities;
-    
-    FILE* fp = std::fopen(FILE_NAME, "r");
-    int px, py, vx, vy;
-    
-    while(std::fscanf(fp, "p=%d,%d v=%d,%d\n", &px, &py, &vx, &vy) == 4) {
-        positions.emplace_back(px, py);
-        velocities.emplace_back(vx, vy);
-    }
-    std::fclose(fp);
-
-    // Find best x and y offsets by calculating variances
-    double min_var_x = std::numeric_limits<double>::max();
-    double min_var_y = std::numeric_limits<double>::max();
-    int best_x = 0, best_y = 0;
-
-    for (int t = 0; t < WIDTH; ++t) {
-        double mean_x = 0;
-        std::vector<int> curr_x;
-        
-        for (size_t i = 0; i < positions.size(); ++i) {
-            int x = positions[i].first + velocities[i].first * t;
-            x = positive_mod(x, WIDTH);
-            curr_x.push_back(x);
-            mean_x += x;
+        if (px != width/2 && py != height/2) {
+            int quadrant_x = px / (width/2 + 1);
+            int quadrant_y = py / (height/2 + 1);
+            count[quadrant_x][quadrant_y]++;
         }
-        mean_x /= positions.size();
+    }
 
-        double variance_x = 0;
-        for (int x : curr_x) {
-            variance_x += (x - mean_x) * (x - mean_x);
-        }
+    return count[0][0] * count[0][1] * count[1][0] * count[1][1];
+}
 
-        if (variance_x < min_var_x) {
-            min_var_x = variance_x;
-            best_x = t;
+// Time at which the robots line up along one axis: the offset (mod `period`)
+// where their coordinates have the least variance.
+template <int Period>
+static int tightest_time(const std::vector<int>& starts, const std::vector<int>& speeds) {
+    constexpr int period = Period;
+    double min_var = std::numeric_limits<double>::max();
+    int best = 0;
+    std::vector<int> curr(starts.size());
+
+    for (int t = 0; t < period; ++t) {
+        double mean = 0;
+        for (size_t i = 0; i < starts.size(); ++i) {
+            curr[i] = positive_mod(starts[i] + speeds[i] * t, period);
+            mean += curr[i];
         }
-    }
+        mean /= starts.size();
 
-    for (int t = 0; t < HEIGHT; ++t) {
-        double mean_y = 0;
-        std::vector<int> curr_y;
-        
-        for (size_t i = 0; i < positions.size(); ++i) {
-            int y = positions[i].second + velocities[i].second * t;
-            y = positive_mod(y, HEIGHT);
-            curr_y.push_back(y);
-            mean_y += y;
+        double variance = 0;
+        for (int v : curr) {
+            variance += (v - mean) * (v - mean);
         }
-        mean_y /= positions.size();
 
-        double variance_y = 0;
-        for (int y : curr_y) {
-            variance_y += (y - mean_y) * (y - mean_y);
+        if (variance < min_var) {
+            min_var = variance;
+            best = t;
         }
+    }
+    return best;
+}
 
-        if (variance_y < min_var_y) {
-            min_var_y = variance_y;
-            best_y = t;
-        }
+static long long easter_egg_time(const std::vector<Robot>& robots) {
+    constexpr int width = WIDTH;
+    constexpr int height = HEIGHT;
+    std::vector<int> xs, ys, vxs, vys;
+    for (const Robot& r : robots) {
+        xs.push_back(r.px);
+        ys.push_back(r.py);
+        vxs.push_back(r.vx);
+        vys.push_back(r.vy);
     }
 
-    // Calculate modular multiplicative inverse of WIDTH mod HEIGHT
+    // Find best x and y offsets by calculating variances
+    const int best_x = tightest_time<WIDTH>(xs, vxs);
+    const int best_y = tightest_time<HEIGHT>(ys, vys);
+
+    // Calculate modular multiplicative inverse of width mod height
     int w_inv = 1;
-    for (int i = 1; i < HEIGHT; ++i) {
-        if ((WIDTH * i) % HEIGHT == 1) {
+    for (int i = 1; i < height; ++i) {
+        if ((width * i) % height == 1) {
             w_inv = i;
             break;
         }
     }
 
     // Calculate final time using CRT
-    int k = ((w_inv * (best_y - best_x)) % HEIGHT + HEIGHT) % HEIGHT;
-    long long result = best_x + k * WIDTH;
+    int k = ((w_inv * (best_y - best_x)) % height + height) % height;
+    return best_x + static_cast<long long>(k) * width;
+}
+
+void day14_part1() {
+#ifdef AOC_CONSTEXPR_SOLVE
+    if (aoc_use_precomputed(FILE_NAME)) {
+        std::cout << "Day 14 Part 1: Safety factor = "
+                  << day14_part1_precomputed() << '\n';
+        return;
+    }
+#endif
+    auto start = std::chrono::high_resolution_clock::now();
+
+    const std::vector<Robot> robots = read_robots();
+    const int safety = safety_factor(robots);
+
+    std::cout << "Day 14 Part 1: Safety factor = " << safety << '\n';
+  auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Execution time: " << duration.count() << " microseconds\n";
+
+}
+
+
+
+
+void day14_part2() {
+#ifdef AOC_CONSTEXPR_SOLVE
+    if (aoc_use_precomputed(FILE_NAME)) {
+        std::cout << "Day 14 Part 2: Time to display Easter egg = "
+                  << day14_part2_precomputed() << '\n';
+        return;
+    }
+#endif
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    const std::vector<Robot> robots = read_robots();
+    const long long result = easter_egg_time(robots);
 
     std::cout << "Day 14 Part 2: Time to display Easter egg = " << result << '\n';
     
@@ -1,11 +1,37 @@
 #include "day15.h"
+#include "input.h"
+#include "packed_grid.h"
+#include "small_vector.h"
 #include <complex>
-#include <fstream>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <string>
 #include <vector>
 
+namespace {
+
+// Two bits per cell. The robot is tracked apart from the grid, so its cell
+// reads EMPTY. Part 1 boxes are a single BOX; part 2's wide boxes are a
+// BOX followed by a BOX_RIGHT.
+enum Tile : unsigned { EMPTY, WALL, BOX, BOX_RIGHT };
+using Tiles = PackedGrid<2>;
+
+// Sum of 100 * row + col over the BOX cells.
+int gps_sum(const Tiles &grid) {
+  int sum = 0;
+  std::vector<std::uint8_t> row(grid.cols());
+  for (int i = 0; i < grid.rows(); i++) {
+    grid.unpack_row(i, row.data());
+    for (int j = 0; j < grid.cols(); j++) {
+      if (row[j] == BOX) {
+        sum += 100 * i + j;
+      }
+    }
+  }
+  return sum;
+}
+
 struct Position {
   int row;
   int col;
@@ -14,12 +40,11 @@ struct Position {
 
 class Warehouse {
 private:
-  std::vector<std::string> grid;
+  Tiles grid;
   Position robot;
 
   bool isValidMove(int row, int col) const {
-    return row >= 0 && row < grid.size() && col >= 0 && col < grid[0].size() &&
-           grid[row][col] != '#';
+    return grid.in_bounds(row, col) && grid.at(row, col) != WALL;
   }
 
   void moveRobot(char direction) {
@@ -47,14 +72,14 @@ private:
       return;
 
     // Handle box pushing
-    if (grid[newRow][newCol] == 'O') {
+    if (grid.at(newRow, newCol) == BOX) {
       std::vector<Position> boxesToMove;
       int checkRow = newRow;
       int checkCol = newCol;
 
       // Find all adjacent boxes in the push direction
       while (isValidMove(checkRow, checkCol) &&
-             grid[checkRow][checkCol] == 'O') {
+             grid.at(checkRow, checkCol) == BOX) {
         boxesToMove.push_back(Position(checkRow, checkCol));
         checkRow += (newRow - robot.row);
         checkCol += (newCol - robot.col);
@@ -68,24 +93,27 @@ private:
       for (auto it = boxesToMove.rbegin(); it != boxesToMove.rend(); ++it) {
         int targetRow = it->row + (newRow - robot.row);
         int targetCol = it->col + (newCol - robot.col);
-        grid[targetRow][targetCol] = 'O';
-        grid[it->row][it->col] = '.';
+        grid.at(targetRow, targetCol) = BOX;
+        grid.at(it->row, it->col) = EMPTY;
       }
     }
 
     // Move robot
-    grid[newRow][newCol] = '@';
-    grid[robot.row][robot.col] = '.';
     robot = Position(newRow, newCol);
   }
 
 public:
-  Warehouse(const std::vector<std::string> &input) : grid(input), robot(0, 0) {
-    for (int i = 0; i < grid.size(); i++) {
-      for (int j = 0; j < grid[i].size(); j++) {
-        if (grid[i][j] == '@') {
+  // input must hold at least one row.
+  Warehouse(const std::vector<std::string> &input)
+      : grid(input.size(), input[0].size(), EMPTY), robot(0, 0) {
+    for (int i = 0; i < grid.rows(); i++) {
+      for (int j = 0; j < grid.cols(); j++) {
+        if (input[i][j] == '#') {
+          grid.at(i, j) = WALL;
+        } else if (input[i][j] == 'O') {
+          grid.at(i, j) = BOX;
+        } else if (input[i][j] == '@') {
           robot = Position(i, j);
-          break;
         }
       }
     }
@@ -98,27 +126,23 @@ public:
   }
 
   void printGrid() const {
-    for (const auto &row : grid) {
-      std::cout << row << std::endl;
+    for (int i = 0; i < grid.rows(); i++) {
+      for (int j = 0; j < grid.cols(); j++) {
+        const bool is_robot = i == robot.row && j == robot.col;
+        std::cout << (is_robot ? '@' : ".#O"[grid.at(i, j)]);
+      }
+      std::cout << '\n';
     }
     std::cout << "\n";
   }
 
-  int calculateGPSSum() const {
-    int sum = 0;
-    for (int i = 0; i < grid.size(); i++) {
-      for (int j = 0; j < grid[i].size(); j++) {
-        if (grid[i][j] == 'O') {
-          sum += (100 * i + j);
-        }
-      }
-    }
-    return sum;
-  }
+  int calculateGPSSum() const { return gps_sum(grid); }
 };
 
+} // namespace
+
 void day15_part1() {
-  std::ifstream file("../inputs/day15.txt");
+  InputStream file("../inputs/day15.txt");
   std::vector<std::string> grid;
   std::string line, movements;
 
@@ -132,52 +156,57 @@ void day15_part1() {
     movements += line;
   }
 
+  if (grid.empty()) {
+    std::cout << "Sum of GPS coordinates: 0\n";
+    return;
+  }
+
   Warehouse warehouse(grid);
   warehouse.processMovements(movements);
   int result = warehouse.calculateGPSSum();
 
-  std::cout << "Sum of GPS coordinates: " << result << std::endl;
+  std::cout << "Sum of GPS coordinates: " << result << '\n';
 }
 
-using ComplexPos = std::complex<int>;
+namespace {
 
-struct ComplexCompare {
-  bool operator()(const std::complex<int> &a,
-                  const std::complex<int> &b) const {
-    if (a.real() != b.real())
-      return a.real() < b.real();
-    return a.imag() < b.imag();
-  }
-};
+// x is the column, y the row.
+using ComplexPos = std::complex<int>;
 
 class WarehouseComplex {
 private:
-  std::map<std::complex<int>, char, ComplexCompare> grid;
+  Tiles grid;
 
   ComplexPos robot;
 
+  Tiles::Cell tile(ComplexPos p) { return grid.at(p.imag(), p.real()); }
+
   bool move(ComplexPos p, ComplexPos d, bool test = true) {
     if (!test && !move(p, d, true))
       return false;
 
-    std::vector<ComplexPos> todo = {p};
+    // At most the box half at p and its partner.
+    small_vector<ComplexPos, 2> todo = {p};
     if (d.imag() != 0) {
-      if (grid[p] == '[')
+      if (tile(p) == BOX)
         todo.push_back(p + ComplexPos(1, 0));
-      if (grid[p] == ']')
+      if (tile(p) == BOX_RIGHT)
         todo.push_back(p + ComplexPos(-1, 0));
     }
 
     for (ComplexPos pos : todo) {
       if (test) {
         ComplexPos next = pos + d;
-        if ((grid[next] == '[' || grid[next] == ']') && !move(next, d, true) ||
-            grid[next] == '#')
+        if ((tile(next) == BOX || tile(next) == BOX_RIGHT) &&
+                !move(next, d, true) ||
+            tile(next) == WALL)
           return false;
       } else {
-        if (grid[pos + d] == '[' || grid[pos + d] == ']')
+        if (tile(pos + d) == BOX || tile(pos + d) == BOX_RIGHT)
           move(pos + d, d, false);
-        std::swap(grid[pos + d], grid[pos]);
+        const unsigned moved = tile(pos);
+        tile(pos) = tile(pos + d);
+        tile(pos + d) = moved;
       }
     }
     return true;
@@ -211,7 +240,14 @@ public:
     return scaled;
   }
 
+  // input must hold at least one row; the last needs no '\n'.
   WarehouseComplex(const std::string &input) {
+    const std::size_t first_break = input.find('\n');
+    const int cols =
+        first_break == std::string::npos ? input.size() : first_break;
+    const int rows = (input.size() + 1) / (cols + 1);
+    grid = Tiles(rows, cols, EMPTY);
+
     int row = 0, col = 0;
     for (char c : input) {
       if (c == '\n') {
@@ -219,8 +255,13 @@ public:
         col = 0;
       } else {
         ComplexPos pos(col, row);
-        grid[pos] = c;
-        if (c == '@')
+        if (c == '#')
+          tile(pos) = WALL;
+        else if (c == '[')
+          tile(pos) = BOX;
+        else if (c == ']')
+          tile(pos) = BOX_RIGHT;
+        else if (c == '@')
           robot = pos;
         col++;
       }
@@ -238,24 +279,24 @@ public:
       robot += d;
   }
 
-  int calculateGPSSum() const {
-    int sum = 0;
-    for (const auto &[pos, c] : grid) {
-      if (c == '[') {
-        sum += pos.real() + pos.imag() * 100;
-      }
-    }
-    return sum;
-  }
+  int calculateGPSSum() const { return gps_sum(grid); }
 };
 
+} // namespace
+
 void day15_part2() {
-  std::ifstream file("../inputs/day15.txt");
+  InputStream file("../inputs/day15.txt");
   std::string input((std::istreambuf_iterator<char>(file)),
                     std::istreambuf_iterator<char>());
 
-  std::string movements = input.substr(input.find("\n\n") + 2);
-  std::string grid = input.substr(0, input.find("\n\n"));
+  const std::size_t split = input.find("\n\n");
+  std::string grid = input.substr(0, split);
+  std::string movements =
+      split == std::string::npos ? "" : input.substr(split + 2);
+  if (grid.empty() || grid[0] == '\n') {
+    std::cout << "Sum of GPS coordinates: 0\n";
+    return;
+  }
 
   auto scaled = WarehouseComplex::scaleUpMap(grid);
   WarehouseComplex warehouse(scaled);
@@ -266,5 +307,5 @@ void day15_part2() {
   }
 
   std::cout << "Sum of GPS coordinates: " << warehouse.calculateGPSSum()
-            << std::endl;
+            << '\n';
 }
@@ -1,61 +1,90 @@
 #include "day16.h"
+#include "input.h"
+#include "packed_grid.h"
+#include "stats.h"
 #include <array>
-#include <fstream>
+#include <climits>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <tuple>
 
-bool operator==(const State &lhs, const State &rhs) {
-  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.dir == rhs.dir;
-}
+namespace day16 {
 
-std::vector<std::string>
-MazeSolver::read_input(const std::string_view &file_name) {
+Grid<char> MazeSolver::read_input(const std::string_view &file_name) {
   std::vector<std::string> maze;
   std::string line;
-  std::ifstream file(file_name.data());
+  InputStream file(file_name);
   while (std::getline(file, line)) {
     if (!line.empty()) {
       maze.push_back(line);
     }
   }
-  return maze;
+  return make_char_grid(maze, '#');
+}
+
+// The puzzle inputs are 141x141; other sizes take the generic path.
+using PuzzleShape = GridShape<141, 141>;
+
+namespace {
+bool is_wall(char c) { return c == '#'; }
+} // namespace
+
+int MazeSolver::solve(const Grid<char> &maze) {
+  return dispatch_grid_shape<PuzzleShape>(
+      maze.rows(), maze.cols(), [&](auto shape) {
+        return lowest_score(pack<1, decltype(shape)>(maze, is_wall),
+                            findStart(maze), findEnd(maze));
+      });
 }
 
-int MazeSolver::solve(const std::vector<std::string> &maze) {
-  auto [startX, startY] = findStart(maze);
-  auto [endX, endY] = findEnd(maze);
+int MazeSolver::count_optimal_paths(const Grid<char> &maze) {
+  return dispatch_grid_shape<PuzzleShape>(
+      maze.rows(), maze.cols(), [&](auto shape) {
+        return count_tiles(pack<1, decltype(shape)>(maze, is_wall),
+                           findStart(maze), findEnd(maze));
+      });
+}
+
+template <typename Walls>
+int MazeSolver::lowest_score(const Walls &walls, std::pair<int, int> start,
+                             std::pair<int, int> end) {
+  // findStart/findEnd give {-1, -1} for a maze without 'S' or 'E'.
+  if (start.first < 0 || end.first < 0) {
+    return -1;
+  }
+  auto [startX, startY] = start;
+  auto [endX, endY] = end;
 
   std::priority_queue<State, std::vector<State>, std::greater<>> pq;
-  std::unordered_set<State, StateHash> visited;
+  // Bit d is set once the cell has been settled facing direction d.
+  typename Walls::template rebind<std::uint8_t> visited(walls.rows(),
+                                                       walls.cols(), 0);
 
   pq.push({startX, startY, EAST, 0});
 
-  const std::vector<std::pair<int, int>> DIRECTIONS = {
-      {-1, 0}, // NORTH
-      {0, 1},  // EAST
-      {1, 0},  // SOUTH
-      {0, -1}  // WEST
-  };
-
   while (!pq.empty()) {
+    AOC_STAT_MAX("day16.heap_high_water", pq.size());
     State current = pq.top();
     pq.pop();
+    AOC_STAT_ADD("day16.pops", 1);
 
     if (current.x == endX && current.y == endY) {
       return current.cost;
     }
 
-    if (visited.count(current))
+    std::uint8_t &seen = visited.at(current.x, current.y);
+    if (seen & (1 << current.dir)) {
+      AOC_STAT_ADD("day16.stale_pops", 1);
       continue;
-    visited.insert(current);
+    }
+    seen |= 1 << current.dir;
 
     // Try moving forward
-    int newX = current.x + DIRECTIONS[current.dir].first;
-    int newY = current.y + DIRECTIONS[current.dir].second;
-    if (isValid(newX, newY, maze)) {
+    int newX = current.x + GRID_STEPS[current.dir].first;
+    int newY = current.y + GRID_STEPS[current.dir].second;
+    if (isValid(newX, newY, walls)) {
       pq.push({newX, newY, current.dir, current.cost + 1});
     }
 
@@ -69,40 +98,38 @@ int MazeSolver::solve(const std::vector<std::string> &maze) {
   return -1;
 }
 
-bool MazeSolver::isValid(int x, int y, const std::vector<std::string> &maze) {
-  return x >= 0 && x < maze.size() && y >= 0 && y < maze[0].size() &&
-         maze[x][y] != '#';
+template <typename Walls>
+bool MazeSolver::isValid(int x, int y, const Walls &walls) {
+  return walls.in_bounds(x, y) && !walls.at(x, y);
 }
 
-std::pair<int, int>
-MazeSolver::findStart(const std::vector<std::string> &maze) {
-  for (int i = 0; i < maze.size(); i++) {
-    for (int j = 0; j < maze[i].size(); j++) {
-      if (maze[i][j] == 'S')
+std::pair<int, int> MazeSolver::findStart(const Grid<char> &maze) {
+  for (int i = 0; i < maze.rows(); i++) {
+    for (int j = 0; j < maze.cols(); j++) {
+      if (maze.at(i, j) == 'S')
         return {i, j};
     }
   }
   return {-1, -1};
 }
 
-std::pair<int, int> MazeSolver::findEnd(const std::vector<std::string> &maze) {
-  for (int i = 0; i < maze.size(); i++) {
-    for (int j = 0; j < maze[i].size(); j++) {
-      if (maze[i][j] == 'E')
+std::pair<int, int> MazeSolver::findEnd(const Grid<char> &maze) {
+  for (int i = 0; i < maze.rows(); i++) {
+    for (int j = 0; j < maze.cols(); j++) {
+      if (maze.at(i, j) == 'E')
         return {i, j};
     }
   }
   return {-1, -1};
 }
 
-void MazeSolver::print_optimal_paths(
-    const std::vector<std::string> &maze,
-    const std::vector<std::vector<bool>> &is_optimal) {
-  for (size_t i = 0; i < maze.size(); i++) {
-    for (size_t j = 0; j < maze[i].size(); j++) {
-      if (maze[i][j] == '#') {
+void MazeSolver::print_optimal_paths(const Grid<char> &maze,
+                                     const Grid<char> &is_optimal) {
+  for (int i = 0; i < maze.rows(); i++) {
+    for (int j = 0; j < maze.cols(); j++) {
+      if (maze.at(i, j) == '#') {
         std::cout << '#';
-      } else if (is_optimal[i][j]) {
+      } else if (is_optimal.at(i, j)) {
         std::cout << 'O';
       } else {
         std::cout << '.';
@@ -112,42 +139,52 @@ void MazeSolver::print_optimal_paths(
   }
 }
 
-void MazeSolver::print_maze(const std::vector<std::string> &maze) {
-  for (const auto &row : maze) {
-    std::cout << row << '\n';
+void MazeSolver::print_maze(const Grid<char> &maze) {
+  for (int i = 0; i < maze.rows(); i++) {
+    for (int j = 0; j < maze.cols(); j++) {
+      std::cout << maze.at(i, j);
+    }
+    std::cout << '\n';
   }
 }
 
-int MazeSolver::count_optimal_paths(const std::vector<std::string> &maze) {
-  std::pair<int, int> start = findStart(maze);
-  std::pair<int, int> end = findEnd(maze);
-
-  const std::unordered_map<Direction, std::pair<int, int>> deltas = {
-      {NORTH, {-1, 0}}, {EAST, {0, 1}}, {SOUTH, {1, 0}}, {WEST, {0, -1}}};
-
-  std::unordered_map<State, int, StateHash> visited;
+template <typename Walls>
+int MazeSolver::count_tiles(const Walls &walls, std::pair<int, int> start,
+                            std::pair<int, int> end) {
+  if (start.first < 0 || end.first < 0) {
+    return -1;
+  }
+  // Best score per cell and facing; UNSEEN until first reached.
+  constexpr int UNSEEN = INT_MAX;
+  typename Walls::template rebind<std::array<int, 4>> best(
+      walls.rows(), walls.cols(), {UNSEEN, UNSEEN, UNSEEN, UNSEEN});
+  auto score_of = [&best](int x, int y, Direction dir) -> int & {
+    return best.at(x, y)[dir];
+  };
   std::priority_queue<std::tuple<int, Direction, int, int>> to_visit;
 
-  visited[{start.first, start.second, EAST, 0}] = 0;
+  score_of(start.first, start.second, EAST) = 0;
   to_visit.push({0, EAST, start.first, start.second});
 
   while (!to_visit.empty()) {
+    AOC_STAT_MAX("day16.heap_high_water", to_visit.size());
     auto [neg_score, dir, x, y] = to_visit.top();
     to_visit.pop();
+    AOC_STAT_ADD("day16.pops", 1);
     int score = -neg_score;
 
-    State current{x, y, dir, 0};
-    if (visited.count(current) && visited[current] < score) {
+    if (score_of(x, y, dir) < score) {
+      AOC_STAT_ADD("day16.stale_pops", 1);
       continue;
     }
 
-    auto [dx, dy] = deltas.at(dir);
+    auto [dx, dy] = GRID_STEPS[dir];
     int nx = x + dx;
     int ny = y + dy;
-    if (isValid(nx, ny, maze)) {
-      State next{nx, ny, dir, 0};
-      if (!visited.count(next) || visited[next] > score + 1) {
-        visited[next] = score + 1;
+    if (isValid(nx, ny, walls)) {
+      int &next = score_of(nx, ny, dir);
+      if (next > score + 1) {
+        next = score + 1;
         to_visit.push({-(score + 1), dir, nx, ny});
       }
     }
@@ -155,24 +192,26 @@ int MazeSolver::count_optimal_paths(const std::vector<std::string> &maze) {
     std::array<Direction, 2> turns = {static_cast<Direction>((dir + 3) % 4),
                                       static_cast<Direction>((dir + 1) % 4)};
     for (Direction new_dir : turns) {
-      State turn_state{x, y, new_dir, 0};
-      if (!visited.count(turn_state) || visited[turn_state] > score + 1000) {
-        visited[turn_state] = score + 1000;
+      int &turned = score_of(x, y, new_dir);
+      if (turned > score + 1000) {
+        turned = score + 1000;
         to_visit.push({-(score + 1000), new_dir, x, y});
       }
     }
   }
 
-  int target_score = INT_MAX;
-  State target_state;
-  for (const auto &[state, score] : visited) {
-    if (state.x == end.first && state.y == end.second && score < target_score) {
-      target_score = score;
-      target_state = state;
+  int target_score = UNSEEN;
+  State target_state{end.first, end.second, EAST, 0};
+  for (Direction dir : {NORTH, EAST, SOUTH, WEST}) {
+    if (score_of(end.first, end.second, dir) < target_score) {
+      target_score = score_of(end.first, end.second, dir);
+      target_state.dir = dir;
     }
   }
 
-  std::unordered_set<std::pair<int, int>, PairHash> unique_positions;
+  typename Walls::template rebind<char> on_path(walls.rows(), walls.cols(),
+                                               false);
+  int unique_positions = 0;
   std::queue<State> trace_queue;
   trace_queue.push(target_state);
 
@@ -180,39 +219,46 @@ int MazeSolver::count_optimal_paths(const std::vector<std::string> &maze) {
     State current = trace_queue.front();
     trace_queue.pop();
 
-    unique_positions.insert({current.x, current.y});
+    char &marked = on_path.at(current.x, current.y);
+    unique_positions += !marked;
+    marked = true;
+    const int current_score = score_of(current.x, current.y, current.dir);
 
-    auto [dx, dy] = deltas.at(current.dir);
+    auto [dx, dy] = GRID_STEPS[current.dir];
     int px = current.x - dx;
     int py = current.y - dy;
 
-    if (isValid(px, py, maze)) {
-      State prev{px, py, current.dir, 0};
-      if (visited.count(prev) && visited[prev] + 1 == visited[current]) {
-        trace_queue.push(prev);
+    if (isValid(px, py, walls)) {
+      const int prev = score_of(px, py, current.dir);
+      if (prev != UNSEEN && prev + 1 == current_score) {
+        trace_queue.push({px, py, current.dir, 0});
       }
     }
 
     for (Direction prev_dir : {static_cast<Direction>((current.dir + 1) % 4),
                                static_cast<Direction>((current.dir + 3) % 4)}) {
-      State prev{current.x, current.y, prev_dir, 0};
-      if (visited.count(prev) && visited[prev] + 1000 == visited[current]) {
-        trace_queue.push(prev);
+      const int prev = score_of(current.x, current.y, prev_dir);
+      if (prev != UNSEEN && prev + 1000 == current_score) {
+        trace_queue.push({current.x, current.y, prev_dir, 0});
       }
     }
   }
 
-  return unique_positions.size();
+  return unique_positions;
 }
 
+} // namespace day16
+
+using day16::MazeSolver;
+
 void day16_part1() {
-  std::vector<std::string> maze = MazeSolver::read_input("../inputs/day16.txt");
+  const Grid<char> maze = MazeSolver::read_input("../inputs/day16.txt");
   int min_cost = MazeSolver::solve(maze);
   std::cout << "Min Cost: " << min_cost << '\n';
 }
 
 void day16_part2() {
-  std::vector<std::string> maze = MazeSolver::read_input("../inputs/day16.txt");
+  const Grid<char> maze = MazeSolver::read_input("../inputs/day16.txt");
   int optimal_paths = MazeSolver::count_optimal_paths(maze);
   std::cout << "Num Optimal Paths: " << optimal_paths << '\n';
 }
@@ -1,4 +1,6 @@
 #include "day17.h"
+#include "input.h"
+#include "stats.h"
 #include <limits.h>
 #include <pthread.h>
 #include <stdbool.h>
@@ -125,11 +127,12 @@ static char *read_line(FILE *file) {
   return line;
 }
 
+// Returns NULL if the input cannot be opened; free with free_program().
 static ProgramData *read_program(const char *filename) {
-  FILE *file = fopen(filename, "r");
+  FILE *file = aoc_open_input(filename);
   if (!file) {
     fprintf(stderr, "Failed to open file: %s\n", filename);
-    exit(1);
+    return NULL;
   }
 
   ProgramData *data = malloc(sizeof(ProgramData));
@@ -158,7 +161,8 @@ static ProgramData *read_program(const char *filename) {
         while (*program_str == ' ')
           program_str++;
 
-        char *token = strtok(program_str, ",");
+        char *save = NULL;
+        char *token = strtok_r(program_str, ",", &save);
         while (token) {
           if (data->prog.size >= capacity) {
             capacity *= 2;
@@ -166,7 +170,7 @@ static ProgramData *read_program(const char *filename) {
                 realloc(data->prog.codes, capacity * sizeof(int));
           }
           data->prog.codes[data->prog.size++] = atoi(token);
-          token = strtok(NULL, ",");
+          token = strtok_r(NULL, ",", &save);
         }
       }
     }
@@ -177,20 +181,32 @@ static ProgramData *read_program(const char *filename) {
   return data;
 }
 
+static void free_program(ProgramData *data) {
+  free(data->prog.codes);
+  free(data);
+}
+
 static void run_program(Computer *cpu, const int *program, int program_start,
                         int length, Output *out) {
   cpu->ip = program_start;
 
+  unsigned long long executed = 0;
   while (cpu->ip < length) {
     int opcode = program[cpu->ip];
     int operand = program[cpu->ip + 1];
     execute_instruction(cpu, opcode, operand, out);
     cpu->ip += 2;
+    executed++;
   }
+  AOC_STAT_ADD("day17.instructions", executed);
+  (void)executed;
 }
 
 void day17_part1(void) {
   ProgramData *data = read_program("../inputs/day17.txt");
+  if (!data) {
+    return;
+  }
 
   Computer cpu = {
       .A = data->regs.A, .B = data->regs.B, .C = data->regs.C, .ip = 0};
@@ -205,8 +221,7 @@ void day17_part1(void) {
   }
   printf("\n");
 
-  free(data->prog.codes);
-  free(data);
+  free_program(data);
   free(out.values);
 }
 
@@ -215,7 +230,7 @@ static void run_with_candidate(Computer *cpu, const int *program, int length,
   run_program(cpu, program, 0, length, out);
 }
 
-int64_t find_self_replicating_value(int *program, int program_length) {
+static int64_t find_self_replicating_value(int *program, int program_length) {
   int64_t a = 0;
 
   for (int i = program_length - 1; i >= 0; i--) {
@@ -254,10 +269,12 @@ int64_t find_self_replicating_value(int *program, int program_length) {
 
 void day17_part2(void) {
   ProgramData *data = read_program("../inputs/day17.txt");
+  if (!data) {
+    return;
+  }
   int64_t result =
       find_self_replicating_value(data->prog.codes, data->prog.size);
   printf("Part 2: %lld\n", result);
 
-  free(data->prog.codes);
-  free(data);
+  free_program(data);
 }
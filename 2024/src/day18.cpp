@@ -1,13 +1,35 @@
 #include "day18.h"
+#include "grid.h"
+#include "input.h"
+#include "packed_grid.h"
+#include <algorithm>
 #include <climits>
-#include <fstream>
 #include <iostream>
 #include <queue>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-const int GRID_SIZE = 71; // 0 to 70 inclusive
+namespace {
+
+// Memory space of the puzzle inputs: 0 to 70 inclusive, the only size
+// solved. The input does not say how large its space is, so the 7x7 example
+// is not supported; the runtime-sized shapes serve --grid-layout and sparse
+// storage, not other sizes.
+const int GRID_SIZE = 71;
+using PuzzleShape = GridShape<GRID_SIZE, GRID_SIZE>;
+
+// The searches reach most cells however few bytes have fallen, so their
+// bookkeeping stays dense when the bytes are kept in a SparseGrid.
+template <typename Shape>
+using SearchShape = std::conditional_t<(Shape::rows < 0), AnyShape, Shape>;
+
+// One bit per cell (fallen or not, visited or not) unless sparse.
+template <typename Shape>
+using BitGrid = std::conditional_t<(Shape::rows < 0), SparseGrid<char>,
+                                   PackedGrid<1, Shape>>;
 
 struct Point {
   int x, y;
@@ -23,7 +45,7 @@ struct Node {
 
 std::vector<Point> readInput() {
   std::vector<Point> points;
-  std::ifstream file("../inputs/day18.txt");
+  InputStream file("../inputs/day18.txt");
   std::string line;
 
   while (std::getline(file, line)) {
@@ -37,36 +59,38 @@ std::vector<Point> readInput() {
   return points;
 }
 
-int findShortestPath(const std::vector<std::vector<bool>> &corrupted) {
-  std::vector<std::vector<int>> dist(GRID_SIZE,
-                                     std::vector<int>(GRID_SIZE, INT_MAX));
+// `corrupted` holds 1 for fallen bytes, indexed (y, x).
+template <typename Shape>
+int findShortestPath(const BitGrid<Shape> &corrupted) {
+  const int size = corrupted.rows();
+  ShapedGrid<int, SearchShape<Shape>> dist(size, size, INT_MAX);
   std::priority_queue<Node, std::vector<Node>, std::greater<Node>> pq;
 
   // Directions: right, down, left, up
   const int dx[] = {1, 0, -1, 0};
   const int dy[] = {0, 1, 0, -1};
 
-  dist[0][0] = 0;
+  dist.at(0, 0) = 0;
   pq.emplace(0, 0, 0);
 
   while (!pq.empty()) {
     Node curr = pq.top();
     pq.pop();
 
-    if (curr.x == GRID_SIZE - 1 && curr.y == GRID_SIZE - 1) {
+    if (curr.x == size - 1 && curr.y == size - 1) {
       return curr.dist;
     }
 
-    if (curr.dist > dist[curr.y][curr.x])
+    if (curr.dist > dist.at(curr.y, curr.x))
       continue;
 
     for (int i = 0; i < 4; i++) {
       int nx = curr.x + dx[i];
       int ny = curr.y + dy[i];
 
-      if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE &&
-          !corrupted[ny][nx] && dist[ny][nx] > curr.dist + 1) {
-        dist[ny][nx] = curr.dist + 1;
+      if (corrupted.in_bounds(ny, nx) && !corrupted.at(ny, nx) &&
+          dist.at(ny, nx) > curr.dist + 1) {
+        dist.at(ny, nx) = curr.dist + 1;
         pq.emplace(nx, ny, curr.dist + 1);
       }
     }
@@ -75,39 +99,57 @@ int findShortestPath(const std::vector<std::vector<bool>> &corrupted) {
   return -1; // No path found
 }
 
-void printGrid(const std::vector<std::vector<bool>> &corrupted) {
-  for (int y = 0; y < GRID_SIZE; y++) {
-    for (int x = 0; x < GRID_SIZE; x++) {
-      std::cout << (corrupted[y][x] ? '#' : '.');
+template <typename Cells> void printGrid(const Cells &corrupted) {
+  for (int y = 0; y < corrupted.rows(); y++) {
+    for (int x = 0; x < corrupted.cols(); x++) {
+      std::cout << (corrupted.at(y, x) ? '#' : '.');
     }
     std::cout << '\n';
   }
   std::cout << '\n';
 }
 
-void day18_part1() {
-  std::vector<Point> points = readInput();
-  std::vector<std::vector<bool>> corrupted(GRID_SIZE,
-                                           std::vector<bool>(GRID_SIZE, false));
+template <typename Shape>
+int shortestAfterFirstBytes(const std::vector<Point> &points, int side) {
+  BitGrid<Shape> corrupted(side, side, 0);
 
   // Mark first 1024 bytes as corrupted
   for (size_t i = 0; i < std::min(size_t(1024), points.size()); i++) {
-    corrupted[points[i].y][points[i].x] = true;
+    corrupted.at(points[i].y, points[i].x) = 1;
   }
 
-  std::cout << "Shortest Path: " << findShortestPath(corrupted) << '\n';
+  return findShortestPath<Shape>(corrupted);
 }
 
-void day18_part2() {
-  std::vector<std::vector<bool>> corrupted(GRID_SIZE,
-                                           std::vector<bool>(GRID_SIZE, false));
+} // namespace
+
+void day18_part1() {
   std::vector<Point> points = readInput();
+  if (points.empty()) {
+    std::cout << "No bytes in input.\n";
+    return;
+  }
+  const std::size_t fallen = std::min(size_t(1024), points.size());
+  const int path = dispatch_grid_density<PuzzleShape>(
+      GRID_SIZE, GRID_SIZE, fallen, [&](auto shape) {
+        return shortestAfterFirstBytes<decltype(shape)>(points, GRID_SIZE);
+      });
+
+  std::cout << "Shortest Path: " << path << '\n';
+}
+
+namespace {
+
+// Index into `points` of the first byte that cuts off the exit, or -1.
+template <typename Shape>
+int firstBlockingByte(const std::vector<Point> &points, int side) {
+  BitGrid<Shape> corrupted(side, side, 0);
 
   // Pre-check optimization: Only test points that could potentially block paths
-  std::vector<bool> visited(GRID_SIZE * GRID_SIZE, false);
+  BitGrid<SearchShape<Shape>> visited(side, side, 0);
   auto isPathPoint = [&](int x, int y) {
-    return x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE &&
-           !corrupted[y][x] && !visited[y * GRID_SIZE + x];
+    return corrupted.in_bounds(y, x) && !std::as_const(corrupted).at(y, x) &&
+           !visited.at(y, x);
   };
 
   // Find initial valid path
@@ -119,12 +161,12 @@ void day18_part2() {
     Point curr = q.front();
     q.pop();
 
-    if (curr.x == GRID_SIZE - 1 && curr.y == GRID_SIZE - 1) {
+    if (curr.x == side - 1 && curr.y == side - 1) {
       break;
     }
 
-    if (!visited[curr.y * GRID_SIZE + curr.x]) {
-      visited[curr.y * GRID_SIZE + curr.x] = true;
+    if (!visited.at(curr.y, curr.x)) {
+      visited.at(curr.y, curr.x) = 1;
       criticalPath.push_back(curr);
 
       // Check adjacent cells
@@ -141,7 +183,8 @@ void day18_part2() {
   }
 
   // Only test points near the critical path
-  for (const Point &p : points) {
+  for (size_t i = 0; i < points.size(); i++) {
+    const Point &p = points[i];
     // Check if point is adjacent to critical path
     bool isNearPath = false;
     for (const Point &cp : criticalPath) {
@@ -154,12 +197,29 @@ void day18_part2() {
     if (!isNearPath)
       continue;
 
-    corrupted[p.y][p.x] = true;
-    int result = findShortestPath(corrupted);
-
-    if (result == -1) {
-      std::cout << "First Byte to block exit: " << p.x << "," << p.y << '\n';
-      return;
+    corrupted.at(p.y, p.x) = 1;
+    if (findShortestPath<Shape>(corrupted) == -1) {
+      return static_cast<int>(i);
     }
   }
+  return -1;
+}
+
+} // namespace
+
+void day18_part2() {
+  std::vector<Point> points = readInput();
+  if (points.empty()) {
+    std::cout << "No bytes in input.\n";
+    return;
+  }
+  const int blocking = dispatch_grid_density<PuzzleShape>(
+      GRID_SIZE, GRID_SIZE, points.size(), [&](auto shape) {
+        return firstBlockingByte<decltype(shape)>(points, GRID_SIZE);
+      });
+
+  if (blocking >= 0) {
+    const Point &p = points[blocking];
+    std::cout << "First Byte to block exit: " << p.x << "," << p.y << '\n';
+  }
 }
@@ -1,3 +1,5 @@
+#include "input.h"
+#include "stats.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -126,8 +128,10 @@ static bool can_make_design_memo(const char *design, PatternList *patterns,
 
   bool cached_result;
   if (bool_memo_lookup(memo, design, &cached_result)) {
+    AOC_STAT_ADD("day19.memo_hits", 1);
     return cached_result;
   }
+  AOC_STAT_ADD("day19.memo_misses", 1);
 
   for (int i = 0; i < patterns->count; i++) {
     const char *pattern = patterns->patterns[i].str;
@@ -154,8 +158,10 @@ static long count_ways_memo(const char *design, PatternList *patterns,
 
   long cached_result;
   if (long_memo_lookup(memo, design, &cached_result)) {
+    AOC_STAT_ADD("day19.memo_hits", 1);
     return cached_result;
   }
+  AOC_STAT_ADD("day19.memo_misses", 1);
 
   long total = 0;
   for (int i = 0; i < patterns->count; i++) {
@@ -172,8 +178,13 @@ static long count_ways_memo(const char *design, PatternList *patterns,
   return total;
 }
 
+// Returns NULL if the input cannot be opened; free with free_input_data().
 static InputData *load_input(const char *filename) {
-  FILE *file = fopen(filename, "r");
+  FILE *file = aoc_open_input(filename);
+  if (!file) {
+    fprintf(stderr, "Failed to open file: %s\n", filename);
+    return NULL;
+  }
   InputData *data = malloc(sizeof(InputData));
   data->patterns = create_pattern_list(10);
   data->designs = create_pattern_list(10);
@@ -186,12 +197,13 @@ static InputData *load_input(const char *filename) {
     line[strlen(line) - 1] = '\0';
   }
 
-  char *token = strtok(line, ", ");
+  char *save = NULL;
+  char *token = strtok_r(line, ", ", &save);
   while (token != NULL) {
     while (*token == ' ')
       token++;
     add_pattern(data->patterns, token);
-    token = strtok(NULL, ", ");
+    token = strtok_r(NULL, ", ", &save);
   }
 
   free(line);
@@ -211,6 +223,8 @@ static InputData *load_input(const char *filename) {
     free(line);
     line = NULL;
   }
+  // getline() may allocate even when it reports end of file.
+  free(line);
 
   fclose(file);
   return data;
@@ -240,8 +254,17 @@ static void free_pattern_list(PatternList *list) {
   free(list);
 }
 
+static void free_input_data(InputData *data) {
+  free_pattern_list(data->patterns);
+  free_pattern_list(data->designs);
+  free(data);
+}
+
 void day19_part1(void) {
   InputData *data = load_input("../inputs/day19.txt");
+  if (!data) {
+    return;
+  }
   BoolMemoTable *memo = create_bool_memo_table(1000);
 
   int possible_count = 0;
@@ -255,12 +278,14 @@ void day19_part1(void) {
   printf("Part 1 Result: %d\n", possible_count);
 
   free_bool_memo_table(memo);
-  free_pattern_list(data->patterns);
-  free_pattern_list(data->designs);
+  free_input_data(data);
 }
 
 void day19_part2(void) {
   InputData *data = load_input("../inputs/day19.txt");
+  if (!data) {
+    return;
+  }
   LongMemoTable *memo = create_long_memo_table(1000);
 
   long total_ways = 0;
@@ -272,7 +297,6 @@ void day19_part2(void) {
   printf("Part 2 Result: %ld\n", total_ways);
 
   free_long_memo_table(memo);
-  free_pattern_list(data->patterns);
-  free_pattern_list(data->designs);
+  free_input_data(data);
 }
 
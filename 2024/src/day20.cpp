@@ -1,16 +1,22 @@
 #include "day20.h"
+#include "grid.h"
+#include "input.h"
+#include "packed_grid.h"
+#include "stats.h"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cmath>
-#include <fstream>
 #include <iostream>
-#include <map>
 #include <queue>
 #include <string>
 #include <vector>
 
+namespace {
+
 class Day20Solver {
 private:
-  std::vector<std::string> grid;
+  Grid<char> grid;
   std::pair<int, int> start;
   std::pair<int, int> end;
   static constexpr std::array<std::pair<int, int>, 4> directions = {
@@ -18,12 +24,13 @@ private:
       std::make_pair(-1, 0)};
 
   void parse(const std::string &fileName) {
-    std::ifstream fin(fileName);
+    InputStream fin(fileName);
+    std::vector<std::string> lines;
     std::string line;
     int r = 0;
 
     while (std::getline(fin, line)) {
-      grid.push_back(line);
+      lines.push_back(line);
       for (int c = 0; c < line.size(); c++) {
         if (line[c] == 'S') {
           start = {r, c};
@@ -33,20 +40,19 @@ private:
       }
       r++;
     }
+    grid = make_char_grid(lines, '#');
   }
 
-  std::vector<std::vector<int>> bfs(const std::vector<std::string> &grid,
-                                    std::pair<int, int> start,
-                                    std::pair<int, int> end) {
-    std::vector<std::vector<int>> visited(
-        grid.size() + 1, std::vector<int>(grid[0].size() + 1, 0));
-    std::vector<std::vector<int>> dist(
-        grid.size() + 1, std::vector<int>(grid[0].size() + 1, -1));
+  // `walls` has a bit set per wall.
+  template <typename Walls>
+  static auto bfs(const Walls &walls, std::pair<int, int> start,
+                  std::pair<int, int> end) {
+    // A cell is visited exactly when its distance has been set.
+    typename Walls::template rebind<int> dist(walls.rows(), walls.cols(), -1);
 
     std::queue<std::pair<std::pair<int, int>, int>> q;
     q.push({start, 0});
-    visited[start.first][start.second] = 1;
-    dist[start.first][start.second] = 0;
+    dist.at(start.first, start.second) = 0;
 
     while (!q.empty()) {
       auto [curr, d] = q.front();
@@ -59,12 +65,10 @@ private:
         int x = curr.first + dir.first;
         int y = curr.second + dir.second;
 
-        if (x < 0 || x >= grid.size() || y < 0 || y >= grid[0].size() ||
-            visited[x][y] || grid[x][y] == '#')
+        if (!walls.in_bounds(x, y) || dist.at(x, y) >= 0 || walls.at(x, y))
           continue;
 
-        visited[x][y] = 1;
-        dist[x][y] = d + 1;
+        dist.at(x, y) = d + 1;
         q.push({{x, y}, d + 1});
       }
     }
@@ -77,39 +81,51 @@ private:
     return std::abs(a.first - b.first) + std::abs(a.second - b.second);
   }
 
+  // The puzzle inputs are 141x141; other sizes take the generic path.
   int solve(int minSteps, int saved) {
-    int sol = 0;
-    int n = grid.size();
+    return dispatch_grid_shape<GridShape<141, 141>>(
+        grid.rows(), grid.cols(), [&](auto shape) {
+          const auto walls = pack<1, decltype(shape)>(
+              grid, [](char c) { return c == '#'; });
+          return count_cheats(walls, minSteps, saved);
+        });
+  }
 
-    std::vector<std::vector<int>> distFromStart = bfs(grid, start, end);
-    std::vector<std::vector<int>> distFromEnd = bfs(grid, end, start);
+  template <typename Walls>
+  int count_cheats(const Walls &walls, int minSteps, int saved) const {
+    int sol = 0;
+    unsigned long long examined = 0;
+    const int rows = walls.rows();
+    const int cols = walls.cols();
 
-    int def = distFromStart[end.first][end.second];
+    const auto distFromStart = bfs(walls, start, end);
+    const auto distFromEnd = bfs(walls, end, start);
 
-    std::map<std::pair<std::pair<int, int>, std::pair<int, int>>, bool> checked;
+    int def = distFromStart.at(end.first, end.second);
 
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        if (grid[i][j] == '#')
+    std::vector<std::uint8_t> row_walls(cols);
+    for (int i = 0; i < rows; i++) {
+      walls.unpack_row(i, row_walls.data());
+      for (int j = 0; j < cols; j++) {
+        if (row_walls[j])
           continue;
 
         for (int k = std::max(0, i - minSteps);
-             k <= std::min(n - 1, i + minSteps); k++) {
+             k <= std::min(rows - 1, i + minSteps); k++) {
           for (int l = std::max(0, j - minSteps);
-               l <= std::min(n - 1, j + minSteps); l++) {
+               l <= std::min(cols - 1, j + minSteps); l++) {
 
-            if (k < 0 || k >= n || l < 0 || l >= n)
-              continue;
-            if (grid[k][l] == '#')
+            if (walls.at(k, l))
               continue;
             if (manhattan({i, j}, {k, l}) > minSteps)
               continue;
 
-            if (distFromStart[i][j] < 0 || distFromEnd[k][l] < 0)
+            if (distFromStart.at(i, j) < 0 || distFromEnd.at(k, l) < 0)
               continue;
 
-            int cheat = distFromStart[i][j] + distFromEnd[k][l] +
+            int cheat = distFromStart.at(i, j) + distFromEnd.at(k, l) +
                         manhattan({i, j}, {k, l});
+            examined++;
 
             if (def - cheat >= saved) {
               sol++;
@@ -119,6 +135,8 @@ private:
       }
     }
 
+    AOC_STAT_ADD("day20.pairs_examined", examined);
+    AOC_STAT_ADD("day20.pairs_accepted", sol);
     return sol;
   }
 
@@ -130,12 +148,14 @@ public:
   int part2(int minSteps, int saved) { return solve(minSteps, saved); }
 };
 
+} // namespace
+
 void day20_part1() {
   Day20Solver solver("../inputs/day20.txt");
-  std::cout << "Part 1: " << solver.part1(2, 100) << std::endl;
+  std::cout << "Part 1: " << solver.part1(2, 100) << '\n';
 }
 
 void day20_part2() {
   Day20Solver solver("../inputs/day20.txt");
-  std::cout << "Part 2: " << solver.part2(20, 100) << std::endl;
+  std::cout << "Part 2: " << solver.part2(20, 100) << '\n';
 }
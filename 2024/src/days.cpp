@@ -0,0 +1,58 @@
+#include "days.h"
+#include "day01.h"
+#include "day02.h"
+#include "day03.h"
+#include "day04.h"
+#include "day05.h"
+#include "day06.h"
+#include "day07.h"
+#include "day08.h"
+#include "day09.h"
+#include "day10.h"
+#include "day11.h"
+#include "day12.h"
+#include "day13.h"
+#include "day14.h"
+#include "day15.h"
+#include "day16.h"
+#include "day17.h"
+#include "day18.h"
+#include "day19.h"
+#include "day20.h"
+#include <array>
+
+namespace {
+constexpr std::array DAYS = {
+    DayEntry{1, day01_part1, day01_part2, "../inputs/day01.txt", true},
+    DayEntry{2, day02_part1, day02_part2, "../inputs/day02.txt", false},
+    DayEntry{3, day03_part1, day03_part2, "../inputs/day03.txt", false},
+    DayEntry{4, day04_part1, day04_part2, "../inputs/day04.txt", false},
+    DayEntry{5, day05_part1, day05_part2, "../inputs/day05.txt", false},
+    DayEntry{6, day06_part1, day06_part2, "../inputs/day06.txt", false},
+    DayEntry{7, day07_part1, day07_part2, "../inputs/day07.txt", false},
+    DayEntry{8, day08_part1, day08_part2, "../inputs/day08.txt", true},
+    DayEntry{9, day09_part1, day09_part2, "../inputs/day09.txt", false},
+    DayEntry{10, day10_part1, day10_part2, "../inputs/day10.txt", false},
+    DayEntry{11, day11_part1, day11_part2, "../inputs/day11.txt", false},
+    DayEntry{12, day12_part1, day12_part2, "../inputs/day12.txt", false},
+    DayEntry{13, day13_part1, day13_part2, "../inputs/day13.txt", false},
+    DayEntry{14, day14_part1, day14_part2, "../inputs/day14.txt", false},
+    DayEntry{15, day15_part1, day15_part2, "../inputs/day15.txt", false},
+    DayEntry{16, day16_part1, day16_part2, "../inputs/day16.txt", false},
+    DayEntry{17, day17_part1, day17_part2, "../inputs/day17.txt", false},
+    DayEntry{18, day18_part1, day18_part2, "../inputs/day18.txt", false},
+    DayEntry{19, day19_part1, day19_part2, "../inputs/day19.txt", false},
+    DayEntry{20, day20_part1, day20_part2, "../inputs/day20.txt", false},
+};
+} // namespace
+
+std::span<const DayEntry> all_days() { return DAYS; }
+
+const DayEntry *find_day(int day) {
+  for (const auto &entry : DAYS) {
+    if (entry.day == day) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,236 @@
+#include "diff.h"
+#include "engine.h"
+#include "input.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Generator = void (*)(std::mt19937 &rng, std::ostream &out);
+
+int uniform(std::mt19937 &rng, int lo, int hi) {
+  return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+// Day 1: short lists that qsort in either engine and lists past the radix
+// sort threshold, with values drawn from a narrow range so the similarity
+// score sees repeats. A quarter of the inputs come sorted, which the fast
+// engine's similarity takes as a merge join.
+void generate_day01(std::mt19937 &rng, std::ostream &out) {
+  const int pairs = uniform(rng, 0, 1) ? uniform(rng, 1, 100)
+                                       : uniform(rng, 1000, 5000);
+  const int max_id = uniform(rng, 0, 1) ? 99999 : uniform(rng, 10, 500);
+  std::vector<int> left, right;
+  for (int i = 0; i < pairs; i++) {
+    left.push_back(uniform(rng, 0, max_id));
+    right.push_back(uniform(rng, 0, max_id));
+  }
+  if (uniform(rng, 0, 3) == 0) {
+    std::sort(left.begin(), left.end());
+    std::sort(right.begin(), right.end());
+  }
+  for (int i = 0; i < pairs; i++) {
+    out << left[i] << "   " << right[i] << "\n";
+  }
+}
+
+// Day 7: half the targets are built from random operators so they are
+// solvable, the rest are random so most are not.
+void generate_day07(std::mt19937 &rng, std::ostream &out) {
+  const int equations = uniform(rng, 1, 40);
+  for (int e = 0; e < equations; e++) {
+    const int count = uniform(rng, 2, 8);
+    std::vector<long long> numbers;
+    for (int i = 0; i < count; i++) {
+      numbers.push_back(uniform(rng, 1, 99));
+    }
+
+    long long target = numbers[0];
+    for (int i = 1; i < count; i++) {
+      switch (uniform(rng, 0, 2)) {
+      case 0:
+        target += numbers[i];
+        break;
+      case 1:
+        target *= numbers[i];
+        break;
+      default:
+        target = std::stoll(std::to_string(target) +
+                            std::to_string(numbers[i]));
+        break;
+      }
+    }
+    if (uniform(rng, 0, 1)) {
+      target = uniform(rng, 1, 1000000);
+    }
+
+    out << target << ":";
+    for (long long n : numbers) {
+      out << " " << n;
+    }
+    out << "\n";
+  }
+}
+
+// Day 10: random heights with increasing trails carved into them, so
+// trailheads actually reach nines.
+void generate_day10(std::mt19937 &rng, std::ostream &out) {
+  const int rows = uniform(rng, 4, 40);
+  const int cols = uniform(rng, 4, 40);
+  std::vector<std::string> grid(rows, std::string(cols, '0'));
+  for (auto &row : grid) {
+    for (char &cell : row) {
+      cell = static_cast<char>('0' + uniform(rng, 0, 9));
+    }
+  }
+
+  const int dr[] = {-1, 0, 1, 0};
+  const int dc[] = {0, 1, 0, -1};
+  const int trails = uniform(rng, 1, rows * cols / 4);
+  for (int t = 0; t < trails; t++) {
+    int row = uniform(rng, 0, rows - 1);
+    int col = uniform(rng, 0, cols - 1);
+    for (char height = '0'; height <= '9'; height++) {
+      grid[row][col] = height;
+      const int dir = uniform(rng, 0, 3);
+      row = std::clamp(row + dr[dir], 0, rows - 1);
+      col = std::clamp(col + dc[dir], 0, cols - 1);
+    }
+  }
+
+  for (const auto &row : grid) {
+    out << row << "\n";
+  }
+}
+
+// Day 13: mostly prizes reachable within 100 presses, some out of range or
+// unreachable, and a few machines with parallel buttons.
+void generate_day13(std::mt19937 &rng, std::ostream &out) {
+  const int machines = uniform(rng, 1, 30);
+  for (int m = 0; m < machines; m++) {
+    long long ax = uniform(rng, 1, 99), ay = uniform(rng, 1, 99);
+    long long bx = uniform(rng, 1, 99), by = uniform(rng, 1, 99);
+    if (uniform(rng, 0, 9) == 0) {
+      const int k = uniform(rng, 1, 4);
+      bx = ax * k;
+      by = ay * k;
+    }
+    const long long a = uniform(rng, 0, 150), b = uniform(rng, 0, 150);
+    long long px = a * ax + b * bx, py = a * ay + b * by;
+    if (uniform(rng, 0, 4) == 0) {
+      px += uniform(rng, 1, 50);
+    }
+
+    out << "Button A: X+" << ax << ", Y+" << ay << "\n"
+        << "Button B: X+" << bx << ", Y+" << by << "\n"
+        << "Prize: X=" << px << ", Y=" << py << "\n\n";
+  }
+}
+
+struct DiffCase {
+  int day;
+  Generator generate;
+};
+
+constexpr DiffCase DIFF_CASES[] = {
+    {1, generate_day01},
+    {7, generate_day07},
+    {10, generate_day10},
+    {13, generate_day13},
+};
+
+Generator find_generator(int day) {
+  for (const auto &c : DIFF_CASES) {
+    if (c.day == day) {
+      return c.generate;
+    }
+  }
+  return nullptr;
+}
+
+// Runs both parts of `entry` under `engine` and returns what they printed.
+std::string capture_output(const DayEntry &entry, int engine) {
+  std::cout.flush();
+  std::fflush(stdout);
+  FILE *capture = std::tmpfile();
+  const int saved = dup(STDOUT_FILENO);
+  dup2(fileno(capture), STDOUT_FILENO);
+
+  aoc_set_engine(engine);
+  entry.part1();
+  entry.part2();
+  aoc_set_engine(AOC_ENGINE_FAST);
+
+  std::cout.flush();
+  std::fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+
+  std::string text;
+  std::rewind(capture);
+  char buffer[4096];
+  size_t n;
+  while ((n = std::fread(buffer, 1, sizeof(buffer), capture)) > 0) {
+    text.append(buffer, n);
+  }
+  std::fclose(capture);
+  return text;
+}
+
+} // namespace
+
+bool has_diff_generator(int day) { return find_generator(day) != nullptr; }
+
+int run_diff(const std::vector<const DayEntry *> &days, int cases) {
+  const auto dir = std::filesystem::temp_directory_path();
+  int mismatches = 0;
+
+  for (const DayEntry *entry : days) {
+    const Generator generate = find_generator(entry->day);
+    if (!generate) {
+      std::cout << "Day " << entry->day << ": no reference engine, skipped\n";
+      continue;
+    }
+
+    int failed = 0;
+    for (int c = 0; c < cases; c++) {
+      // Seeded by day and case so a failure reproduces on every run.
+      std::mt19937 rng(entry->day * 100003u + c);
+      const auto path = dir / ("aoc_diff_day" + std::to_string(entry->day) +
+                               "_" + std::to_string(c) + ".txt");
+      {
+        std::ofstream file(path);
+        generate(rng, file);
+      }
+
+      aoc_redirect_input(path.c_str());
+      const std::string reference =
+          capture_output(*entry, AOC_ENGINE_REFERENCE);
+      const std::string fast = capture_output(*entry, AOC_ENGINE_FAST);
+      aoc_redirect_input(nullptr);
+
+      if (reference == fast) {
+        std::filesystem::remove(path);
+        continue;
+      }
+      failed++;
+      std::cout << "Day " << entry->day << ": engines disagree on " << path
+                << "\n-- reference:\n"
+                << reference << "-- fast:\n"
+                << fast;
+    }
+
+    std::cout << "Day " << entry->day << ": " << cases - failed << "/"
+              << cases << " generated inputs agree\n";
+    mismatches += failed;
+  }
+  return mismatches;
+}
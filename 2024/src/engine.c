@@ -0,0 +1,20 @@
+#include "engine.h"
+#include <string.h>
+
+AOC_THREAD_LOCAL int aoc_engine = AOC_ENGINE_FAST;
+
+void aoc_set_engine(int engine) { aoc_engine = engine; }
+
+int aoc_parse_engine(const char *name) {
+  if (strcmp(name, "fast") == 0) {
+    return AOC_ENGINE_FAST;
+  }
+  if (strcmp(name, "reference") == 0) {
+    return AOC_ENGINE_REFERENCE;
+  }
+  return -1;
+}
+
+const char *aoc_engine_name(int engine) {
+  return engine == AOC_ENGINE_REFERENCE ? "reference" : "fast";
+}
@@ -0,0 +1,65 @@
+#include "grid.h"
+#include <atomic>
+
+namespace {
+std::atomic<GridLayout> default_layout{GridLayout::RowMajor};
+std::atomic<GridStorage> default_storage{GridStorage::Auto};
+} // namespace
+
+void set_grid_layout(GridLayout layout) { default_layout = layout; }
+
+GridLayout grid_layout() { return default_layout; }
+
+std::optional<GridLayout> parse_grid_layout(std::string_view name) {
+  if (name == "row") {
+    return GridLayout::RowMajor;
+  }
+  if (name == "tiled") {
+    return GridLayout::Tiled;
+  }
+  if (name == "morton") {
+    return GridLayout::Morton;
+  }
+  return std::nullopt;
+}
+
+const char *grid_layout_name(GridLayout layout) {
+  switch (layout) {
+  case GridLayout::Tiled:
+    return "tiled";
+  case GridLayout::Morton:
+    return "morton";
+  case GridLayout::RowMajor:
+    break;
+  }
+  return "row";
+}
+
+void set_grid_storage(GridStorage storage) { default_storage = storage; }
+
+GridStorage grid_storage() { return default_storage; }
+
+std::optional<GridStorage> parse_grid_storage(std::string_view name) {
+  if (name == "auto") {
+    return GridStorage::Auto;
+  }
+  if (name == "dense") {
+    return GridStorage::Dense;
+  }
+  if (name == "sparse") {
+    return GridStorage::Sparse;
+  }
+  return std::nullopt;
+}
+
+const char *grid_storage_name(GridStorage storage) {
+  switch (storage) {
+  case GridStorage::Dense:
+    return "dense";
+  case GridStorage::Sparse:
+    return "sparse";
+  case GridStorage::Auto:
+    break;
+  }
+  return "auto";
+}
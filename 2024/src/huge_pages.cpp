@@ -0,0 +1,46 @@
+#include "huge_pages.h"
+#include <atomic>
+#include <sys/mman.h>
+
+namespace {
+std::atomic<bool> use_huge_pages{false};
+
+std::size_t mapping_length(std::size_t bytes) {
+  return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+} // namespace
+
+void set_huge_pages(bool enabled) { use_huge_pages = enabled; }
+
+bool huge_pages_enabled() { return use_huge_pages; }
+
+void *huge_alloc(std::size_t bytes) {
+  const std::size_t length = mapping_length(bytes);
+  constexpr int prot = PROT_READ | PROT_WRITE;
+  constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+  void *ptr = MAP_FAILED;
+  if (use_huge_pages) {
+#ifdef MAP_HUGETLB
+    ptr = mmap(nullptr, length, prot, flags | MAP_HUGETLB, -1, 0);
+#endif
+  }
+  if (ptr == MAP_FAILED) {
+    ptr = mmap(nullptr, length, prot, flags, -1, 0);
+    if (ptr == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages) {
+      madvise(ptr, length, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  return ptr;
+}
+
+void huge_free(void *ptr, std::size_t bytes) {
+  if (ptr) {
+    munmap(ptr, mapping_length(bytes));
+  }
+}
@@ -0,0 +1,90 @@
+#include "input.h"
+#include "prefetch.h"
+#include <string>
+#include <string_view>
+
+#ifdef AOC_EMBED_INPUTS
+#include "embedded_inputs.h"
+#endif
+
+namespace {
+thread_local std::string redirect;
+
+// Where an open request is served from: the redirect target if one is set,
+// then the embedded copy, then a prefetched buffer, then the file itself.
+struct Source {
+  std::string path;
+  const char *data = nullptr;
+  size_t size = 0;
+};
+
+Source resolve(const char *path) {
+  Source source{redirect.empty() ? std::string(path) : redirect};
+  source.data = aoc_embedded_input(source.path.c_str(), &source.size);
+  if (!source.data &&
+      !prefetched_input(source.path, &source.data, &source.size)) {
+    source.data = nullptr;
+  }
+  return source;
+}
+} // namespace
+
+extern "C" void aoc_redirect_input(const char *path) {
+  redirect = path ? path : "";
+}
+
+extern "C" const char *aoc_input_path(const char *path) {
+  return redirect.empty() ? path : redirect.c_str();
+}
+
+extern "C" const char *aoc_embedded_input(const char *path, size_t *size) {
+#ifdef AOC_EMBED_INPUTS
+  for (const auto &input : EMBEDDED_INPUTS) {
+    if (input.path == std::string_view(path)) {
+      *size = input.data.size();
+      return input.data.data();
+    }
+  }
+#else
+  (void)path;
+  (void)size;
+#endif
+  return nullptr;
+}
+
+extern "C" FILE *aoc_open_input(const char *path) {
+  const Source source = resolve(path);
+  if (source.data) {
+    // fmemopen rejects zero-length buffers.
+    return source.size ? fmemopen(const_cast<char *>(source.data),
+                                  source.size, "r")
+                       : fopen("/dev/null", "r");
+  }
+  return fopen(source.path.c_str(), "r");
+}
+
+void InputStream::MemoryBuf::assign(const char *data, size_t size) {
+  char *begin = const_cast<char *>(data);
+  setg(begin, begin, begin + size);
+}
+
+InputStream::InputStream(std::string_view path) : std::istream(nullptr) {
+  const Source source = resolve(std::string(path).c_str());
+  if (source.data) {
+    memory.assign(source.data, source.size);
+    rdbuf(&memory);
+    open = true;
+  } else if (file.open(source.path, std::ios::in)) {
+    rdbuf(&file);
+    open = true;
+  } else {
+    setstate(std::ios::failbit);
+  }
+}
+
+void InputStream::close() {
+  if (file.is_open()) {
+    file.close();
+  }
+  open = false;
+}
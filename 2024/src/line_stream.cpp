@@ -0,0 +1,54 @@
+#include "line_stream.h"
+#include "input.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <vector>
+
+Generator<std::string_view> read_chunks(std::string path,
+                                        std::size_t chunk_size) {
+  // Closed by the frame's destructor even if the consumer stops early.
+  std::unique_ptr<FILE, int (*)(FILE *)> file(aoc_open_input(path.c_str()),
+                                              std::fclose);
+  if (!file) {
+    co_return;
+  }
+
+  // Memory-backed inputs (embedded, prefetched) have no descriptor.
+  const int fd = fileno(file.get());
+  std::vector<char> buffer(chunk_size);
+  off_t offset = 0;
+
+  size_t n;
+  while ((n = std::fread(buffer.data(), 1, buffer.size(), file.get())) > 0) {
+    offset += static_cast<off_t>(n);
+    if (fd >= 0) {
+      posix_fadvise(fd, offset, static_cast<off_t>(chunk_size),
+                    POSIX_FADV_WILLNEED);
+    }
+    co_yield std::string_view(buffer.data(), n);
+  }
+}
+
+Generator<std::string_view> split_lines(Generator<std::string_view> chunks) {
+  std::string carry;
+
+  for (std::string_view chunk : chunks) {
+    size_t newline;
+    while ((newline = chunk.find('\n')) != std::string_view::npos) {
+      if (carry.empty()) {
+        co_yield chunk.substr(0, newline);
+      } else {
+        carry.append(chunk.substr(0, newline));
+        co_yield std::string_view(carry);
+        carry.clear();
+      }
+      chunk.remove_prefix(newline + 1);
+    }
+    carry.append(chunk);
+  }
+
+  if (!carry.empty()) {
+    co_yield std::string_view(carry);
+  }
+}
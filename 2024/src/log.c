@@ -0,0 +1,22 @@
+#include "log.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+int aoc_verbosity = AOC_LOG_QUIET;
+
+void aoc_set_verbosity(int level) {
+  if (level > AOC_MAX_VERBOSITY) {
+    level = AOC_MAX_VERBOSITY;
+  }
+  if (level > AOC_LOG_QUIET && aoc_verbosity == AOC_LOG_QUIET) {
+    setvbuf(stderr, NULL, _IOFBF, 1 << 16);
+  }
+  aoc_verbosity = level;
+}
+
+void aoc_log_printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
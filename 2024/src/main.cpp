@@ -1,127 +1,319 @@
 #include "day01.h"
-#include "day02.h"
-#include "day03.h"
-#include "day04.h"
-#include "day05.h"
-#include "day06.h"
-#include "day07.h"
-#include "day08.h"
-#include "day09.h"
-#include "day10.h"
-#include "day11.h"
-#include "day12.h"
-#include "day13.h"
-#include "day14.h"
-#include "day15.h"
-#include "day16.h"
-#include "day17.h"
-#include "day18.h"
-#include "day19.h"
-#include "day20.h"
+#include "days.h"
+#include "diff.h"
+#include "engine.h"
+#include "grid.h"
+#include "input.h"
+#include "log.h"
+#include "prefetch.h"
+#include "profiler.h"
+#include "shard.h"
+#include "soak.h"
+#include "stats.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// How many upcoming batch inputs are read ahead of the one being solved.
+constexpr size_t PREFETCH_WINDOW = 8;
+
+// Generated inputs per day for --diff unless --cases says otherwise.
+constexpr int DEFAULT_DIFF_CASES = 100;
+
+struct Job {
+  const DayEntry *entry;
+  std::string input;
+  int engine;
+};
+
+void print_usage(const char *prog) {
+  std::cout
+      << "Usage: " << prog << " [-v|-vv] [--engine E] <day_number>...\n"
+      << "       " << prog << " [-v|-vv] [--engine E] all\n"
+      << "       " << prog << " [-v|-vv] [--engine E] --batch <jobs_file>\n"
+      << "       " << prog
+      << " [--workers N] [--engine E] --batch <jobs_file>\n"
+      << "       " << prog << " --diff [--cases N] [<day_number>...]\n"
+      << "A jobs file lists one \"<day_number> <input_path>\" per line.\n"
+      << "-v prints per-record solver diagnostics to stderr, -vv also "
+         "per-line and grid dumps.\n"
+      << "--engine reference|fast picks the implementation for the days "
+         "after it\n"
+      << "(default fast); --diff runs both on generated inputs and compares "
+         "them.\n"
+      << "--grid-layout row|tiled|morton sets the memory order of the grids "
+         "in days\n"
+      << "12, 16 and 20 (default row).\n"
+      << "--grid-storage auto|dense|sparse picks how days 08 and 18 store "
+         "their grids\n"
+      << "(default auto: sparse when few cells are set).\n"
+      << "--memory-limit MIB caps the pairs day 1 holds in memory; longer "
+         "inputs are\n"
+      << "sorted in runs spilled to temp files (default: a quarter of RAM).\n"
+      << "--profile FILE samples the run and writes folded stacks for "
+         "flamegraph tools.\n"
+      << "--workers N runs the jobs in N forked processes (0: one per CPU) "
+         "and prints\n"
+      << "their answers in job order.\n"
+      << "--soak N runs each day N times in-process and reports time, RSS "
+         "and heap\n"
+      << "growth per iteration.\n"
+      << "--stats prints each day's work counters to stderr (needs a "
+         "-DAOC_STATS=ON build).\n";
+}
+
+bool read_jobs(const std::string &file_name, int engine,
+               std::vector<Job> &jobs) {
+  std::ifstream file(file_name);
+  if (!file.is_open()) {
+    std::cout << "Cannot open " << file_name << '\n';
+    return false;
+  }
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    std::istringstream iss(line);
+    int day;
+    std::string input;
+    if (!(iss >> day)) {
+      continue; // blank line
+    }
+    const DayEntry *entry = find_day(day);
+    if (!entry || !(iss >> input)) {
+      std::cout << file_name << ":" << line_number << ": bad job\n";
+      return false;
+    }
+    jobs.push_back({entry, input, engine});
+  }
+  return true;
+}
+
+void solve(const Job &job, bool stats) {
+  aoc_set_engine(job.engine);
+  aoc_stats_reset();
+  job.entry->part1();
+  job.entry->part2();
+  if (stats) {
+    std::cout.flush();
+    std::fprintf(stderr, "-- Day %d stats\n", job.entry->day);
+    aoc_stats_print(stderr);
+  }
+}
+
+void run_job(const Job &job, bool batch, bool stats) {
+  if (batch) {
+    std::cout << "== Day " << job.entry->day << ": " << job.input << '\n';
+    aoc_redirect_input(job.input.c_str());
+  }
+  solve(job, stats);
+  aoc_redirect_input(nullptr);
+}
+
+// Runs the jobs in order while the next PREFETCH_WINDOW inputs load in the
+// background, so a solver rarely blocks on a cold read.
+void run_jobs(const std::vector<Job> &jobs, bool batch, bool stats) {
+  size_t queued = 0;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    std::vector<std::string> upcoming;
+    for (; queued < jobs.size() && queued < i + PREFETCH_WINDOW; queued++) {
+      upcoming.push_back(jobs[queued].input);
+    }
+    prefetch_inputs(upcoming);
+
+    run_job(jobs[i], batch, stats);
+    drop_prefetched_input(jobs[i].input);
+  }
+}
+
+int run_diff_mode(const std::vector<Job> &jobs, int cases) {
+  std::vector<const DayEntry *> days;
+  for (const auto &job : jobs) {
+    days.push_back(job.entry);
+  }
+  if (days.empty()) {
+    for (const auto &entry : all_days()) {
+      if (has_diff_generator(entry.day)) {
+        days.push_back(&entry);
+      }
+    }
+  }
+  return run_diff(days, cases) == 0 ? 0 : 1;
+}
+
+int run_soak_mode(const std::vector<Job> &jobs, bool batch, int iterations) {
+  bool steady = true;
+  for (const Job &job : jobs) {
+    const std::string label = "day " + std::to_string(job.entry->day) +
+                              (batch ? " " + job.input : "");
+    steady &= run_soak(label, iterations, [&] {
+      if (batch) {
+        aoc_redirect_input(job.input.c_str());
+      }
+      aoc_set_engine(job.engine);
+      job.entry->part1();
+      job.entry->part2();
+      aoc_redirect_input(nullptr);
+    });
+  }
+  return steady ? 0 : 1;
+}
+
+int run(const std::vector<Job> &jobs, bool batch, bool stats, int workers) {
+  // Each worker reads its own inputs, so there is no prefetching here.
+  if (workers > 0) {
+    const int failed = run_sharded(jobs.size(), workers, [&](std::size_t i) {
+      run_job(jobs[i], batch, stats);
+    });
+    return failed == 0 ? 0 : 1;
+  }
+
+  // A single day gains nothing from reading ahead.
+  if (jobs.size() == 1 && !batch) {
+    solve(jobs[0], stats);
+    return 0;
+  }
+
+  run_jobs(jobs, batch, stats);
+  return 0;
+}
+
+} // namespace
 
 int main(int argc, char *argv[]) {
+  // Answers are collected and written in large blocks rather than per line;
+  // printf and std::cout share this buffer, so their order is preserved.
+  std::setvbuf(stdout, nullptr, _IOFBF, 1 << 16);
 
-  if (argc != 2) {
-    std::cout << "Usage: " << argv[0] << " <day_number>" << std::endl;
+  int arg = 1;
+  int verbosity = AOC_LOG_QUIET;
+  for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == 'v'; arg++) {
+    const std::string flag = argv[arg];
+    if (flag.find_first_not_of('v', 1) != std::string::npos) {
+      break;
+    }
+    verbosity += static_cast<int>(flag.size()) - 1;
+  }
+  aoc_set_verbosity(verbosity);
+  if (verbosity > AOC_MAX_VERBOSITY) {
+    std::cerr << "Verbosity " << verbosity << " requested but only "
+              << AOC_MAX_VERBOSITY
+              << " is compiled in; rebuild with -DAOC_MAX_VERBOSITY=2\n";
+  }
+
+  if (argc - arg < 1) {
+    print_usage(argv[0]);
     return 1;
   }
 
-  int day = std::atoi(argv[1]);
-
-  switch (day) {
-  case 1:
-    day01_part1();
-    day01_part2();
-    break;
-
-  case 2:
-    day02_part1();
-    day02_part2();
-    break;
-
-  case 3:
-    day03_part1();
-    day03_part2();
-    break;
-
-  case 4:
-    day04_part1();
-    day04_part2();
-    break;
-  case 5:
-    day05_part1();
-    day05_part2();
-    break;
-
-  case 6:
-    day06_part1();
-    day06_part2();
-    break;
-
-  case 7:
-    day07_part1();
-    day07_part2();
-    break;
-
-  case 8:
-    day08_part1();
-    day08_part2();
-    break;
-
-  case 9:
-    day09_part1();
-    day09_part2();
-    break;
-  case 10:
-    day10_part1();
-    day10_part2();
-    break;
-  case 11:
-    day11_part1();
-    day11_part2();
-    break;
-
-  case 12:
-    day12_part1();
-    day12_part2();
-    break;
-  case 13:
-    day13_part1();
-    day13_part2();
-    break;
-  case 14:
-    day14_part1();
-    day14_part2();
-    break;
-  case 15:
-    day15_part1();
-    day15_part2();
-    break;
-
-  case 16:
-    day16_part1();
-    day16_part2();
-    break;
-  case 17:
-    day17_part1();
-    day17_part2();
-    break;
-  case 18:
-    day18_part1();
-    day18_part2();
-    break;
-  case 19:
-    day19_part1();
-    day19_part2();
-    break;
-  case 20:
-    day20_part1();
-    day20_part2();
-    break;
-  default:
-    std::cout << "Day " << day << " not implemented yet!" << std::endl;
+  std::vector<Job> jobs;
+  int engine = AOC_ENGINE_FAST;
+  bool batch = false;
+  bool diff = false;
+  int diff_cases = DEFAULT_DIFF_CASES;
+  std::string profile_path;
+  bool stats = false;
+  int workers = 0; // in-process
+  int soak_iterations = 0;
+
+  for (; arg < argc; arg++) {
+    const std::string option = argv[arg];
+    const bool has_value = arg + 1 < argc;
+    if (option == "--engine" && has_value) {
+      engine = aoc_parse_engine(argv[++arg]);
+      if (engine < 0) {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (option == "--batch" && has_value) {
+      if (!read_jobs(argv[++arg], engine, jobs)) {
+        print_usage(argv[0]);
+        return 1;
+      }
+      batch = true;
+    } else if (option == "--grid-layout" && has_value) {
+      const auto layout = parse_grid_layout(argv[++arg]);
+      if (!layout) {
+        print_usage(argv[0]);
+        return 1;
+      }
+      set_grid_layout(*layout);
+    } else if (option == "--grid-storage" && has_value) {
+      const auto storage = parse_grid_storage(argv[++arg]);
+      if (!storage) {
+        print_usage(argv[0]);
+        return 1;
+      }
+      set_grid_storage(*storage);
+    } else if (option == "--memory-limit" && has_value) {
+      const long mib = std::atol(argv[++arg]);
+      if (mib < 0) {
+        print_usage(argv[0]);
+        return 1;
+      }
+      day01_set_memory_limit(static_cast<size_t>(mib) << 20);
+    } else if (option == "--profile" && has_value) {
+      profile_path = argv[++arg];
+    } else if (option == "--workers" && has_value) {
+      workers = std::atoi(argv[++arg]);
+      if (workers <= 0) {
+        workers = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+      }
+    } else if (option == "--soak" && has_value) {
+      soak_iterations = std::atoi(argv[++arg]);
+    } else if (option == "--stats") {
+      stats = true;
+    } else if (option == "--diff") {
+      diff = true;
+    } else if (option == "--cases" && has_value) {
+      diff_cases = std::atoi(argv[++arg]);
+    } else if (option == "all") {
+      for (const auto &entry : all_days()) {
+        jobs.push_back({&entry, entry.input, engine});
+      }
+    } else if (option[0] == '-') {
+      // Unknown, or an option whose value is missing.
+      std::cerr << "Unrecognized option " << option << '\n';
+      print_usage(argv[0]);
+      return 1;
+    } else {
+      int day = std::atoi(argv[arg]);
+      const DayEntry *entry = find_day(day);
+      if (!entry) {
+        std::cout << "Day " << day << " not implemented yet!\n";
+        continue;
+      }
+      jobs.push_back({entry, entry->input, engine});
+    }
   }
 
-  return 0;
+  if (stats && !AOC_STATS_ENABLED) {
+    std::cerr << "Work counters are not compiled in; rebuild with "
+                 "-DAOC_STATS=ON\n";
+  }
+  if (!profile_path.empty() && !start_profiler(profile_path)) {
+    std::cerr << "Cannot start the profiler for " << profile_path << '\n';
+    return 1;
+  }
+  int status;
+  if (diff) {
+    status = run_diff_mode(jobs, diff_cases);
+  } else if (soak_iterations > 0) {
+    status = run_soak_mode(jobs, batch, soak_iterations);
+  } else {
+    status = run(jobs, batch, stats, workers);
+  }
+  if (!stop_profiler()) {
+    std::cerr << "Cannot write " << profile_path << '\n';
+    return 1;
+  }
+  return status;
 }
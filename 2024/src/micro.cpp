@@ -0,0 +1,347 @@
+#include "bench_baseline.h"
+#include "generator.h"
+#include "line_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Microbenchmarks for the building blocks the solvers share, each run at
+// working-set sizes that sit in L1, L2, the last-level cache and DRAM. When
+// a day regresses, the kernel whose ns/op moved tells which primitive to
+// look at first.
+
+namespace {
+
+struct Options {
+  std::string kernel; // empty runs every kernel
+  int reps = 5;
+  std::size_t max_bytes = 256 << 20; // levels above this are skipped
+};
+
+struct CacheLevel {
+  const char *name;
+  std::size_t bytes; // working set the kernels are sized to
+};
+
+// A kernel prepares data for a working set of `bytes` and returns the timed
+// body, which reports how many operations it performed.
+using Kernel = std::function<std::function<std::size_t()>(std::size_t bytes)>;
+
+struct MicroBench {
+  const char *name;
+  const char *op; // what one operation is, for the report
+  Kernel setup;
+};
+
+volatile std::uint64_t sink;
+
+std::size_t cache_size(int name, std::size_t fallback) {
+  const long size = sysconf(name);
+  return size > 0 ? static_cast<std::size_t>(size) : fallback;
+}
+
+// Half of each cache so the set stays resident next to the stack and code,
+// and twice the last level for DRAM.
+std::vector<CacheLevel> cache_levels() {
+  const std::size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+  const std::size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 1 << 20);
+  const std::size_t llc = cache_size(_SC_LEVEL3_CACHE_SIZE, 32 << 20);
+  return {{"L1", l1 / 2}, {"L2", l2 / 2}, {"LLC", llc / 2}, {"DRAM", llc * 2}};
+}
+
+// Newline-separated integers like most inputs: up to six digits each.
+std::string make_number_lines(std::size_t bytes) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> value(0, 999999);
+  std::string text;
+  text.reserve(bytes + 8);
+  while (text.size() < bytes) {
+    text += std::to_string(value(rng));
+    text += '\n';
+  }
+  return text;
+}
+
+Generator<std::string_view> memory_chunks(std::string_view text,
+                                          std::size_t chunk_size) {
+  while (!text.empty()) {
+    std::string_view chunk = text.substr(0, chunk_size);
+    text.remove_prefix(chunk.size());
+    co_yield chunk;
+  }
+}
+
+// Open grid with 20% walls, stored row-major like the solvers' grids.
+std::vector<char> make_maze(int side) {
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::vector<char> grid(static_cast<std::size_t>(side) * side);
+  for (char &cell : grid) {
+    cell = percent(rng) < 20 ? '#' : '.';
+  }
+  grid[0] = '.';
+  return grid;
+}
+
+int side_for(std::size_t bytes, std::size_t bytes_per_cell) {
+  return std::max(8, static_cast<int>(std::sqrt(bytes / bytes_per_cell)));
+}
+
+const MicroBench KERNELS[] = {
+    {"parse_int", "int",
+     [](std::size_t bytes) {
+       auto text = std::make_shared<std::string>(make_number_lines(bytes));
+       return [text]() -> std::size_t {
+         const char *p = text->c_str();
+         char *end;
+         std::size_t count = 0;
+         std::uint64_t sum = 0;
+         for (long v = std::strtol(p, &end, 10); end != p;
+              v = std::strtol(p, &end, 10)) {
+           sum += v;
+           count++;
+           p = end;
+         }
+         sink = sum;
+         return count;
+       };
+     }},
+
+    {"split_lines", "line",
+     [](std::size_t bytes) {
+       auto text = std::make_shared<std::string>(make_number_lines(bytes));
+       return [text]() -> std::size_t {
+         std::size_t count = 0;
+         std::uint64_t length = 0;
+         for (std::string_view line :
+              split_lines(memory_chunks(*text, DEFAULT_CHUNK_SIZE))) {
+           length += line.size();
+           count++;
+         }
+         sink = length;
+         return count;
+       };
+     }},
+
+    // Node-based std::unordered_map costs roughly 32 bytes per entry plus
+    // the bucket array.
+    {"hash_insert", "insert",
+     [](std::size_t bytes) {
+       const std::size_t n = std::max<std::size_t>(bytes / 40, 16);
+       return [n]() -> std::size_t {
+         std::unordered_map<long long, long long> map;
+         for (std::size_t i = 0; i < n; i++) {
+           map[static_cast<long long>(i * 2654435761u)] = i;
+         }
+         sink = map.size();
+         return n;
+       };
+     }},
+
+    {"hash_lookup", "lookup",
+     [](std::size_t bytes) {
+       const std::size_t n = std::max<std::size_t>(bytes / 40, 16);
+       auto map = std::make_shared<std::unordered_map<long long, long long>>();
+       for (std::size_t i = 0; i < n; i++) {
+         (*map)[static_cast<long long>(i * 2654435761u)] = i;
+       }
+       auto keys = std::make_shared<std::vector<long long>>();
+       std::mt19937 rng(3);
+       std::uniform_int_distribution<std::size_t> pick(0, 2 * n);
+       for (std::size_t i = 0; i < n; i++) {
+         keys->push_back(static_cast<long long>(pick(rng) * 2654435761u));
+       }
+       return [map, keys]() -> std::size_t {
+         std::uint64_t found = 0;
+         for (long long key : *keys) {
+           found += map->count(key);
+         }
+         sink = found;
+         return keys->size();
+       };
+     }},
+
+    // Grid byte plus an int distance per cell.
+    {"bfs", "cell",
+     [](std::size_t bytes) {
+       const int side = side_for(bytes, 1 + sizeof(int));
+       auto grid = std::make_shared<std::vector<char>>(make_maze(side));
+       return [grid, side]() -> std::size_t {
+         std::vector<int> dist(grid->size(), -1);
+         std::queue<std::pair<int, int>> q;
+         q.push({0, 0});
+         dist[0] = 0;
+         const int dr[] = {-1, 0, 1, 0};
+         const int dc[] = {0, 1, 0, -1};
+         std::size_t visited = 0;
+         while (!q.empty()) {
+           auto [row, col] = q.front();
+           q.pop();
+           visited++;
+           const std::size_t here = static_cast<std::size_t>(row) * side + col;
+           for (int i = 0; i < 4; i++) {
+             const int r = row + dr[i];
+             const int c = col + dc[i];
+             if (r < 0 || r >= side || c < 0 || c >= side) {
+               continue;
+             }
+             const std::size_t index = static_cast<std::size_t>(r) * side + c;
+             if ((*grid)[index] != '#' && dist[index] < 0) {
+               dist[index] = dist[here] + 1;
+               q.push({r, c});
+             }
+           }
+         }
+         sink = visited;
+         return visited;
+       };
+     }},
+
+    // Dijkstra-style (cost, node) pairs; one op is a push plus its pop.
+    {"priority_queue", "push+pop",
+     [](std::size_t bytes) {
+       const std::size_t n =
+           std::max<std::size_t>(bytes / sizeof(std::pair<int, int>), 16);
+       auto costs = std::make_shared<std::vector<int>>();
+       std::mt19937 rng(4);
+       std::uniform_int_distribution<int> cost(0, 1 << 20);
+       for (std::size_t i = 0; i < n; i++) {
+         costs->push_back(cost(rng));
+       }
+       return [costs]() -> std::size_t {
+         std::priority_queue<std::pair<int, int>,
+                             std::vector<std::pair<int, int>>, std::greater<>>
+             pq;
+         for (std::size_t i = 0; i < costs->size(); i++) {
+           pq.push({(*costs)[i], static_cast<int>(i)});
+         }
+         std::uint64_t order = 0;
+         while (!pq.empty()) {
+           order = order * 31 + pq.top().second;
+           pq.pop();
+         }
+         sink = order;
+         return costs->size();
+       };
+     }},
+
+    // Four-neighbour scan comparing plants, as in the region days.
+    {"grid_neighbors", "cell",
+     [](std::size_t bytes) {
+       const int side = side_for(bytes, 1);
+       auto grid = std::make_shared<std::vector<char>>(make_maze(side));
+       return [grid, side]() -> std::size_t {
+         const int dr[] = {-1, 0, 1, 0};
+         const int dc[] = {0, 1, 0, -1};
+         std::uint64_t same = 0;
+         for (int row = 0; row < side; row++) {
+           for (int col = 0; col < side; col++) {
+             const char plant =
+                 (*grid)[static_cast<std::size_t>(row) * side + col];
+             for (int i = 0; i < 4; i++) {
+               const int r = row + dr[i];
+               const int c = col + dc[i];
+               same += r >= 0 && r < side && c >= 0 && c < side &&
+                       (*grid)[static_cast<std::size_t>(r) * side + c] == plant;
+             }
+           }
+         }
+         sink = same;
+         return static_cast<std::size_t>(side) * side;
+       };
+     }},
+};
+
+void print_usage(const char *prog) {
+  std::cerr << "Usage: " << prog << " [options]\n"
+            << "  --kernel NAME  run a single kernel (default: all)\n"
+            << "  --reps N       timed repetitions per size (default: 5)\n"
+            << "  --max-bytes N  skip working sets above N bytes "
+               "(default: 256 MiB)\n"
+            << "Kernels:";
+  for (const auto &kernel : KERNELS) {
+    std::cerr << ' ' << kernel.name;
+  }
+  std::cerr << '\n';
+}
+
+bool parse_options(int argc, char *argv[], Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--kernel" && i + 1 < argc) {
+      opts.kernel = argv[++i];
+    } else if (arg == "--reps" && i + 1 < argc) {
+      opts.reps = std::atoi(argv[++i]);
+    } else if (arg == "--max-bytes" && i + 1 < argc) {
+      opts.max_bytes = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+  return opts.reps > 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  if (!parse_options(argc, argv, opts)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  const auto levels = cache_levels();
+  std::cout << std::left << std::setw(16) << "kernel" << std::setw(6)
+            << "level" << std::setw(12) << "bytes" << std::setw(12) << "ops"
+            << "ns/op\n";
+
+  bool ran = false;
+  for (const auto &kernel : KERNELS) {
+    if (!opts.kernel.empty() && opts.kernel != kernel.name) {
+      continue;
+    }
+    ran = true;
+
+    for (const auto &level : levels) {
+      if (level.bytes > opts.max_bytes) {
+        continue;
+      }
+      const auto body = kernel.setup(level.bytes);
+      std::size_t ops = body(); // warm-up, also faults the pages in
+      std::vector<double> samples;
+      for (int i = 0; i < opts.reps; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        ops = body();
+        const auto end = std::chrono::steady_clock::now();
+        samples.push_back(
+            std::chrono::duration<double, std::nano>(end - start).count() /
+            ops);
+      }
+
+      std::cout << std::left << std::setw(16) << kernel.name << std::setw(6)
+                << level.name << std::setw(12) << level.bytes << std::setw(12)
+                << ops << std::fixed << std::setprecision(2)
+                << median(samples) << " per " << kernel.op << '\n';
+    }
+  }
+
+  if (!ran) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  return 0;
+}
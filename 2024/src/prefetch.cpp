@@ -0,0 +1,477 @@
+#include "prefetch.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef AOC_HAVE_IO_URING
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+struct Entry {
+  enum class State { Pending, Ready, Failed };
+  State state = State::Pending;
+  std::vector<char> data;
+};
+
+// One file being loaded. `entry->data` is written without the lock: nobody
+// reads it until the state leaves Pending under the lock.
+struct Job {
+  Entry *entry;
+  std::string path;
+  int fd = -1;
+  size_t done = 0;
+  bool finished = false;
+  bool reading = false; // a ring read into `entry->data` is outstanding
+};
+
+#ifdef AOC_HAVE_IO_URING
+// Just enough of io_uring to queue reads and reap their completions,
+// talking to the kernel directly so there is no liburing dependency.
+class Ring {
+public:
+  Ring() = default;
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+
+  ~Ring() {
+    if (sqes) {
+      munmap(sqes, sqes_len);
+    }
+    if (cq_ptr && cq_ptr != sq_ptr) {
+      munmap(cq_ptr, cq_len);
+    }
+    if (sq_ptr) {
+      munmap(sq_ptr, sq_len);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  bool init(unsigned depth) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (fd < 0) {
+      return false;
+    }
+
+    sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_len = cq_len = std::max(sq_len, cq_len);
+    }
+
+    sq_ptr = map(sq_len, IORING_OFF_SQ_RING);
+    cq_ptr = single_mmap ? sq_ptr : map(cq_len, IORING_OFF_CQ_RING);
+    sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(map(sqes_len, IORING_OFF_SQES));
+    if (!sq_ptr || !cq_ptr || !sqes) {
+      return false;
+    }
+
+    char *sq = static_cast<char *>(sq_ptr);
+    char *cq = static_cast<char *>(cq_ptr);
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    capacity = params.sq_entries;
+    return true;
+  }
+
+  unsigned free_slots() const { return capacity - in_flight; }
+  unsigned pending() const { return in_flight; }
+  unsigned queued() const { return unsubmitted; }
+
+  void queue_read(int file, char *buffer, unsigned length, uint64_t offset,
+                  uint64_t user_data) {
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & sq_mask;
+    io_uring_sqe &sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<uint64_t>(buffer);
+    sqe.len = length;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    unsubmitted++;
+    in_flight++;
+  }
+
+  // Submits everything queued and blocks for at least one completion.
+  bool submit_and_wait() { return enter(unsubmitted); }
+
+  // Blocks for at least one completion without submitting anything.
+  bool wait() { return enter(0); }
+
+  // Takes back the reads queued since the last successful submit. The
+  // kernel has not seen them, so their buffers are free again.
+  void discard_unsubmitted() {
+    __atomic_store_n(sq_tail, *sq_tail - unsubmitted, __ATOMIC_RELEASE);
+    in_flight -= unsubmitted;
+    unsubmitted = 0;
+  }
+
+  bool pop(uint64_t &user_data, int &result) {
+    const unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const io_uring_cqe &cqe = cqes[head & cq_mask];
+    user_data = cqe.user_data;
+    result = cqe.res;
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    in_flight--;
+    return true;
+  }
+
+private:
+  bool enter(unsigned to_submit) {
+    while (true) {
+      const long submitted =
+          syscall(__NR_io_uring_enter, fd, to_submit, 1,
+                  IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (submitted >= 0) {
+        unsubmitted -= static_cast<unsigned>(submitted);
+        return true;
+      }
+      if (errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  void *map(size_t length, off_t offset) const {
+    void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  int fd = -1;
+  void *sq_ptr = nullptr;
+  void *cq_ptr = nullptr;
+  size_t sq_len = 0;
+  size_t cq_len = 0;
+  size_t sqes_len = 0;
+  io_uring_sqe *sqes = nullptr;
+  unsigned *sq_tail = nullptr;
+  unsigned *sq_array = nullptr;
+  unsigned sq_mask = 0;
+  unsigned *cq_head = nullptr;
+  unsigned *cq_tail = nullptr;
+  unsigned cq_mask = 0;
+  io_uring_cqe *cqes = nullptr;
+  unsigned capacity = 0;
+  unsigned in_flight = 0;
+  unsigned unsubmitted = 0;
+};
+#endif
+
+// Inputs are loaded by one long-lived thread, started on the first
+// request and fed through `queue`; on Linux it keeps a single ring for its
+// whole life.
+class Prefetcher {
+public:
+  ~Prefetcher() {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    work.notify_one();
+    if (loader.joinable()) {
+      loader.join();
+    }
+  }
+
+  void enqueue(const std::vector<std::string> &paths) {
+    std::lock_guard lock(mutex);
+    bool added = false;
+    for (const auto &path : paths) {
+      auto [it, inserted] = entries.try_emplace(path);
+      if (inserted) {
+        it->second = std::make_unique<Entry>();
+        queue.push_back({it->second.get(), path});
+        added = true;
+      }
+    }
+    if (added) {
+      if (!loader.joinable()) {
+        loader = std::thread([this] { run(); });
+      }
+      work.notify_one();
+    }
+  }
+
+  bool get(std::string_view path, const char **data, size_t *size) {
+    std::unique_lock lock(mutex);
+    const auto it = entries.find(path);
+    if (it == entries.end()) {
+      return false;
+    }
+    const Entry *entry = it->second.get();
+    ready.wait(lock, [entry] { return entry->state != Entry::State::Pending; });
+    if (entry->state == Entry::State::Failed) {
+      return false;
+    }
+    *data = entry->data.data();
+    *size = entry->data.size();
+    return true;
+  }
+
+  void drop(std::string_view path) {
+    std::unique_lock lock(mutex);
+    const auto it = entries.find(path);
+    if (it == entries.end()) {
+      return;
+    }
+    const Entry *entry = it->second.get();
+    ready.wait(lock, [entry] { return entry->state != Entry::State::Pending; });
+    entries.erase(it);
+  }
+
+  const char *backend() const { return backend_name; }
+
+private:
+  // The loader thread: takes everything queued so far and loads it as one
+  // batch, until asked to stop with nothing left in the queue.
+  void run() {
+#ifdef AOC_HAVE_IO_URING
+    constexpr unsigned DEPTH = 32;
+    auto ring = std::make_unique<Ring>();
+    if (!ring->init(DEPTH)) {
+      ring.reset();
+    }
+    backend_name = ring ? "io_uring" : "thread";
+#else
+    backend_name = "thread";
+#endif
+
+    while (true) {
+      std::vector<Job> jobs;
+      {
+        std::unique_lock lock(mutex);
+        work.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        }
+        jobs.assign(std::make_move_iterator(queue.begin()),
+                    std::make_move_iterator(queue.end()));
+        queue.clear();
+      }
+
+      open_all(jobs);
+#ifdef AOC_HAVE_IO_URING
+      if (ring && !load_with_io_uring(*ring, jobs)) {
+        // The ring cannot submit anymore; later batches use plain reads.
+        ring.reset();
+        backend_name = "thread";
+      }
+#endif
+      for (auto &job : jobs) {
+        if (!job.finished) {
+          read_rest(job);
+        }
+      }
+    }
+  }
+
+  void finish(Job &job, bool ok) {
+    if (job.fd >= 0) {
+      close(job.fd);
+      job.fd = -1;
+    }
+    job.finished = true;
+    if (ok) {
+      job.entry->data.resize(job.done);
+    }
+    std::lock_guard lock(mutex);
+    job.entry->state = ok ? Entry::State::Ready : Entry::State::Failed;
+    ready.notify_all();
+  }
+
+  // Blocking read of whatever is left of one job.
+  void read_rest(Job &job) {
+    auto &buffer = job.entry->data;
+    while (job.done < buffer.size()) {
+      const ssize_t n =
+          pread(job.fd, buffer.data() + job.done, buffer.size() - job.done,
+                static_cast<off_t>(job.done));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        finish(job, n == 0);
+        return;
+      }
+      job.done += static_cast<size_t>(n);
+    }
+    finish(job, true);
+  }
+
+  void open_all(std::vector<Job> &jobs) {
+    for (auto &job : jobs) {
+      job.fd = open(job.path.c_str(), O_RDONLY | O_CLOEXEC);
+      struct stat st;
+      if (job.fd < 0 || fstat(job.fd, &st) != 0) {
+        finish(job, false);
+        continue;
+      }
+      job.entry->data.resize(static_cast<size_t>(st.st_size));
+      if (st.st_size == 0) {
+        finish(job, true);
+      }
+    }
+  }
+
+#ifdef AOC_HAVE_IO_URING
+  // Loads the batch through the ring. Returns false if a submit failed;
+  // the ring is then drained and the unfinished jobs are left for
+  // read_rest.
+  bool load_with_io_uring(Ring &ring, std::vector<Job> &jobs) {
+    constexpr size_t MAX_READ = 1u << 30;
+
+    std::deque<size_t> to_submit;
+    for (size_t i = 0; i < jobs.size(); i++) {
+      if (!jobs[i].finished) {
+        to_submit.push_back(i);
+      }
+    }
+    // Jobs whose reads are queued but not yet submitted, oldest first.
+    std::deque<size_t> unsubmitted;
+
+    size_t outstanding = to_submit.size();
+    while (outstanding) {
+      while (!to_submit.empty() && ring.free_slots()) {
+        Job &job = jobs[to_submit.front()];
+        const size_t length =
+            std::min(job.entry->data.size() - job.done, MAX_READ);
+        ring.queue_read(job.fd, job.entry->data.data() + job.done,
+                        static_cast<unsigned>(length), job.done,
+                        to_submit.front());
+        job.reading = true;
+        unsubmitted.push_back(to_submit.front());
+        to_submit.pop_front();
+      }
+
+      if (!ring.submit_and_wait()) {
+        ring.discard_unsubmitted();
+        for (const size_t index : unsubmitted) {
+          jobs[index].reading = false;
+        }
+        drain(ring, jobs);
+        return false;
+      }
+      while (unsubmitted.size() > ring.queued()) {
+        unsubmitted.pop_front();
+      }
+
+      uint64_t index;
+      int result;
+      while (ring.pop(index, result)) {
+        Job &job = jobs[index];
+        job.reading = false;
+        if (result == -EINTR || result == -EAGAIN) {
+          to_submit.push_back(index);
+          continue;
+        }
+        if (result < 0) {
+          // e.g. a kernel without IORING_OP_READ
+          read_rest(job);
+        } else if (result == 0) {
+          finish(job, true); // file shrank since fstat
+        } else if ((job.done += static_cast<size_t>(result)) <
+                   job.entry->data.size()) {
+          to_submit.push_back(index);
+          continue;
+        } else {
+          finish(job, true);
+        }
+        outstanding--;
+      }
+    }
+    return true;
+  }
+
+  // Reaps the reads the kernel already has, so no buffer is still being
+  // written when its job falls back to read_rest. If even waiting fails,
+  // the jobs still reading fail, and their buffers are kept until the
+  // prefetcher goes away rather than freed under the kernel.
+  void drain(Ring &ring, std::vector<Job> &jobs) {
+    uint64_t index;
+    int result;
+    while (ring.pending()) {
+      while (ring.pop(index, result)) {
+        Job &job = jobs[index];
+        job.reading = false;
+        if (result > 0) {
+          job.done += static_cast<size_t>(result);
+        }
+      }
+      if (ring.pending() && !ring.wait()) {
+        break;
+      }
+    }
+    for (auto &job : jobs) {
+      if (job.reading) {
+        abandoned.push_back(std::move(job.entry->data));
+        finish(job, false);
+      }
+    }
+  }
+#endif
+
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable work;
+  std::map<std::string, std::unique_ptr<Entry>, std::less<>> entries;
+  std::deque<Job> queue;
+  bool stopping = false;
+  std::thread loader;
+  std::vector<std::vector<char>> abandoned;
+  std::atomic<const char *> backend_name{"none"};
+};
+
+Prefetcher &prefetcher() {
+  static Prefetcher instance;
+  return instance;
+}
+
+} // namespace
+
+void prefetch_inputs(const std::vector<std::string> &paths) {
+  prefetcher().enqueue(paths);
+}
+
+bool prefetched_input(std::string_view path, const char **data,
+                      std::size_t *size) {
+  return prefetcher().get(path, data, size);
+}
+
+void drop_prefetched_input(std::string_view path) {
+  prefetcher().drop(path);
+}
+
+const char *prefetch_backend() { return prefetcher().backend(); }
@@ -0,0 +1,360 @@
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <ucontext.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#ifdef AOC_HAVE_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#endif
+
+namespace {
+
+constexpr std::size_t MAX_DEPTH = 64;
+constexpr std::size_t MAX_SAMPLES = 1 << 14;
+// A saved frame pointer further than this above the interrupted stack
+// pointer is taken as garbage rather than followed.
+constexpr std::uintptr_t MAX_STACK_BYTES = 64 << 20;
+
+struct Sample {
+  std::atomic<std::uint32_t> depth; // set last; 0 while being written
+  std::uintptr_t pcs[MAX_DEPTH];    // innermost first
+};
+
+// Everything the signal handler touches is set up before the timer starts
+// and only read or atomically updated inside it.
+std::unique_ptr<Sample[]> samples;
+std::atomic<std::size_t> next_sample{0};
+std::atomic<std::size_t> dropped{0};
+int probe_pipe[2] = {-1, -1};
+timer_t timer;
+bool running = false;
+std::string output_path;
+
+// Checks that `bytes` at `ptr` can be read without faulting: the kernel
+// copies them into a pipe and reports EFAULT instead of raising SIGSEGV.
+// Both calls are async-signal-safe.
+bool readable(const void *ptr, std::size_t bytes) {
+  if (write(probe_pipe[1], ptr, bytes) != static_cast<ssize_t>(bytes)) {
+    return false;
+  }
+  char drain[2 * sizeof(std::uintptr_t)];
+  (void)!read(probe_pipe[0], drain, sizeof(drain));
+  return true;
+}
+
+std::uint32_t walk_stack(void *context, std::uintptr_t *pcs) {
+  std::uint32_t depth = 0;
+#if defined(AOC_HAVE_LIBUNWIND)
+  unw_cursor_t cursor;
+  if (unw_init_local2(&cursor, static_cast<unw_context_t *>(context),
+                      UNW_INIT_SIGNAL_FRAME) < 0) {
+    return 0;
+  }
+  do {
+    unw_word_t ip;
+    if (unw_get_reg(&cursor, UNW_REG_IP, &ip) < 0 || ip == 0) {
+      break;
+    }
+    pcs[depth++] = ip;
+  } while (depth < MAX_DEPTH && unw_step(&cursor) > 0);
+#else
+  const auto *uc = static_cast<const ucontext_t *>(context);
+#if defined(__x86_64__)
+  std::uintptr_t pc = uc->uc_mcontext.gregs[REG_RIP];
+  std::uintptr_t fp = uc->uc_mcontext.gregs[REG_RBP];
+  const std::uintptr_t sp = uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+  std::uintptr_t pc = uc->uc_mcontext.pc;
+  std::uintptr_t fp = uc->uc_mcontext.regs[29];
+  const std::uintptr_t sp = uc->uc_mcontext.sp;
+#else
+  return 0;
+#endif
+  pcs[depth++] = pc;
+  // Each frame starts with {caller's frame pointer, return address}.
+  while (depth < MAX_DEPTH && fp >= sp && fp - sp < MAX_STACK_BYTES &&
+         fp % sizeof(std::uintptr_t) == 0) {
+    const auto *frame = reinterpret_cast<const std::uintptr_t *>(fp);
+    if (!readable(frame, 2 * sizeof(std::uintptr_t))) {
+      break;
+    }
+    if (frame[1] == 0) {
+      break;
+    }
+    pcs[depth++] = frame[1];
+    if (frame[0] <= fp) {
+      break;
+    }
+    fp = frame[0];
+  }
+#endif
+  return depth;
+}
+
+void on_sigprof(int, siginfo_t *, void *context) {
+  const int saved_errno = errno;
+  const std::size_t index =
+      next_sample.fetch_add(1, std::memory_order_relaxed);
+  if (index < MAX_SAMPLES) {
+    Sample &sample = samples[index];
+    const std::uint32_t depth = walk_stack(context, sample.pcs);
+    sample.depth.store(depth, std::memory_order_release);
+  } else {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  errno = saved_errno;
+}
+
+// Function symbols of the running executable from its .symtab, which,
+// unlike the dynamic symbols dladdr() sees, includes static functions and
+// anonymous-namespace code.
+class ExecutableSymbols {
+public:
+  void load() {
+    std::ifstream file("/proc/self/exe", std::ios::binary);
+    const std::vector<char> image((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+    if (image.size() < sizeof(Elf64_Ehdr)) {
+      return;
+    }
+    Elf64_Ehdr header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 ||
+        header.e_ident[EI_CLASS] != ELFCLASS64 ||
+        header.e_shoff + header.e_shnum * sizeof(Elf64_Shdr) >
+            image.size()) {
+      return;
+    }
+    position_independent = header.e_type == ET_DYN;
+
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), image.data() + header.e_shoff,
+                sections.size() * sizeof(Elf64_Shdr));
+    for (const auto &section : sections) {
+      if (section.sh_type != SHT_SYMTAB ||
+          section.sh_link >= sections.size()) {
+        continue;
+      }
+      const Elf64_Shdr &strings = sections[section.sh_link];
+      if (section.sh_offset + section.sh_size > image.size() ||
+          strings.sh_offset + strings.sh_size > image.size()) {
+        continue;
+      }
+      const std::size_t count = section.sh_size / sizeof(Elf64_Sym);
+      for (std::size_t i = 0; i < count; i++) {
+        Elf64_Sym symbol;
+        std::memcpy(&symbol,
+                    image.data() + section.sh_offset + i * sizeof(Elf64_Sym),
+                    sizeof(symbol));
+        if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC ||
+            symbol.st_size == 0 || symbol.st_name >= strings.sh_size) {
+          continue;
+        }
+        functions.push_back({symbol.st_value, symbol.st_size,
+                             image.data() + strings.sh_offset +
+                                 symbol.st_name});
+      }
+    }
+    std::sort(functions.begin(), functions.end(),
+              [](const Function &a, const Function &b) {
+                return a.start < b.start;
+              });
+  }
+
+  // `address` relative to the executable's load base.
+  const std::string *find(std::uintptr_t base, std::uintptr_t address) const {
+    const std::uintptr_t value = position_independent ? address - base
+                                                      : address;
+    auto it = std::upper_bound(
+        functions.begin(), functions.end(), value,
+        [](std::uintptr_t v, const Function &f) { return v < f.start; });
+    if (it == functions.begin()) {
+      return nullptr;
+    }
+    --it;
+    return value < it->start + it->size ? &it->name : nullptr;
+  }
+
+private:
+  struct Function {
+    std::uintptr_t start;
+    std::uintptr_t size;
+    std::string name;
+  };
+
+  std::vector<Function> functions;
+  bool position_independent = false;
+};
+
+std::string demangle(const char *name) {
+  int status = 0;
+  char *readable_name = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status != 0 || !readable_name) {
+    return name;
+  }
+  std::string out = readable_name;
+  std::free(readable_name);
+  return out;
+}
+
+class Symbolizer {
+public:
+  Symbolizer() {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void *>(&start_profiler), &info)) {
+      executable_base = reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+    }
+    executable.load();
+  }
+
+  const std::string &name(std::uintptr_t pc) {
+    auto [it, inserted] = cache.try_emplace(pc);
+    if (inserted) {
+      it->second = lookup(pc);
+    }
+    return it->second;
+  }
+
+private:
+  std::string lookup(std::uintptr_t pc) {
+    Dl_info info;
+    if (!dladdr(reinterpret_cast<void *>(pc), &info)) {
+      std::ostringstream out;
+      out << "0x" << std::hex << pc;
+      return out.str();
+    }
+    const auto base = reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+    if (base == executable_base) {
+      if (const std::string *symbol = executable.find(base, pc)) {
+        return demangle(symbol->c_str());
+      }
+    }
+    if (info.dli_sname) {
+      return demangle(info.dli_sname);
+    }
+    const char *module = info.dli_fname ? std::strrchr(info.dli_fname, '/')
+                                        : nullptr;
+    std::ostringstream out;
+    out << (module ? module + 1 : "?") << "+0x" << std::hex << pc - base;
+    return out.str();
+  }
+
+  ExecutableSymbols executable;
+  std::uintptr_t executable_base = 0;
+  std::unordered_map<std::uintptr_t, std::string> cache;
+};
+
+// Folded stacks separate frames with ';'; the count follows the last
+// space, so spaces inside a frame are fine.
+std::string sanitize(std::string frame) {
+  std::replace(frame.begin(), frame.end(), ';', ':');
+  return frame;
+}
+
+} // namespace
+
+bool start_profiler(const std::string &path, int hz) {
+  if (running || hz <= 0) {
+    return false;
+  }
+  {
+    std::ofstream probe(path);
+    if (!probe.is_open()) {
+      return false;
+    }
+  }
+  if (pipe2(probe_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return false;
+  }
+
+  samples = std::make_unique<Sample[]>(MAX_SAMPLES);
+  next_sample = 0;
+  dropped = 0;
+  output_path = path;
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_sigaction = on_sigprof;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGPROF, &action, nullptr);
+
+  // Process CPU time, so every thread that burns CPU gets sampled.
+  struct sigevent event;
+  std::memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_SIGNAL;
+  event.sigev_signo = SIGPROF;
+  if (timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &timer) != 0) {
+    signal(SIGPROF, SIG_DFL);
+    return false;
+  }
+  itimerspec interval;
+  std::memset(&interval, 0, sizeof(interval));
+  interval.it_interval.tv_nsec = 1000000000L / hz;
+  interval.it_value = interval.it_interval;
+  timer_settime(timer, 0, &interval, nullptr);
+  running = true;
+  return true;
+}
+
+bool stop_profiler() {
+  if (!running) {
+    return true;
+  }
+  running = false;
+  timer_delete(timer);
+  signal(SIGPROF, SIG_IGN);
+
+  Symbolizer symbolizer;
+  std::map<std::string, std::size_t> stacks;
+  const std::size_t taken = std::min(next_sample.load(), MAX_SAMPLES);
+  for (std::size_t i = 0; i < taken; i++) {
+    const Sample &sample = samples[i];
+    const std::uint32_t depth = sample.depth.load(std::memory_order_acquire);
+    if (depth == 0) {
+      continue;
+    }
+    std::string stack;
+    for (std::uint32_t d = depth; d-- > 0;) {
+      // Return addresses point past the call; step back into it.
+      const std::uintptr_t pc = d == 0 ? sample.pcs[d] : sample.pcs[d] - 1;
+      if (!stack.empty()) {
+        stack += ';';
+      }
+      stack += sanitize(symbolizer.name(pc));
+    }
+    stacks[stack]++;
+  }
+
+  close(probe_pipe[0]);
+  close(probe_pipe[1]);
+  samples.reset();
+
+  std::ofstream out(output_path);
+  for (const auto &[stack, count] : stacks) {
+    out << stack << ' ' << count << '\n';
+  }
+  std::fprintf(stderr, "profile: %zu samples (%zu dropped) written to %s\n",
+               taken, dropped.load(), output_path.c_str());
+  return static_cast<bool>(out);
+}
@@ -0,0 +1,187 @@
+#include "shard.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Answers are a few lines per day; anything longer is cut here.
+constexpr std::size_t SLOT_OUTPUT = 4096 - 64;
+
+enum SlotState : std::uint32_t { PENDING, RUNNING, DONE, FAILED };
+
+// Shared between the parent and every worker.
+struct alignas(64) Queue {
+  std::atomic<std::size_t> next{0};
+};
+
+struct alignas(64) Slot {
+  std::atomic<std::uint32_t> state{PENDING}; // published last
+  pid_t worker = 0;
+  int wait_status = 0; // why the worker died, for FAILED slots; -1 unknown
+  std::uint32_t length = 0;
+  bool truncated = false;
+  char output[SLOT_OUTPUT];
+};
+
+static_assert(std::atomic<std::size_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared-memory atomics must not need a process-local lock");
+
+[[noreturn]] void worker_main(Queue *queue, Slot *slots, std::size_t count,
+                              const std::function<void(std::size_t)> &run) {
+  std::FILE *capture = std::tmpfile();
+  if (!capture) {
+    _exit(2);
+  }
+  const int fd = fileno(capture);
+  dup2(fd, STDOUT_FILENO);
+
+  for (;;) {
+    const std::size_t i = queue->next.fetch_add(1);
+    if (i >= count) {
+      break;
+    }
+    Slot &slot = slots[i];
+    slot.worker = getpid();
+    slot.state.store(RUNNING, std::memory_order_release);
+
+    (void)!ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    run(i);
+    std::cout.flush();
+    std::fflush(stdout);
+
+    struct stat st;
+    const std::size_t size = fstat(fd, &st) == 0 ? st.st_size : 0;
+    const ssize_t n = pread(fd, slot.output, std::min(size, SLOT_OUTPUT), 0);
+    slot.length = n > 0 ? static_cast<std::uint32_t>(n) : 0;
+    slot.truncated = size > SLOT_OUTPUT;
+    slot.state.store(DONE, std::memory_order_release);
+  }
+  _exit(0);
+}
+
+pid_t spawn_worker(Queue *queue, Slot *slots, std::size_t count,
+                   const std::function<void(std::size_t)> &run) {
+  const pid_t pid = fork();
+  if (pid == 0) {
+    worker_main(queue, slots, count, run);
+  }
+  return pid;
+}
+
+void describe_failure(std::size_t index, int status) {
+  std::cerr << "Job " << index + 1 << ": worker ";
+  if (status < 0) {
+    std::cerr << "lost";
+  } else if (WIFSIGNALED(status)) {
+    std::cerr << "killed by signal " << WTERMSIG(status);
+  } else {
+    std::cerr << "exited with status " << WEXITSTATUS(status);
+  }
+  std::cerr << '\n';
+}
+
+} // namespace
+
+int run_sharded(std::size_t count, int workers,
+                const std::function<void(std::size_t)> &run) {
+  const std::size_t bytes = sizeof(Queue) + count * sizeof(Slot);
+  void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    std::cerr << "Cannot map the shared result table\n";
+    return static_cast<int>(count);
+  }
+  auto *queue = new (memory) Queue;
+  auto *slots = reinterpret_cast<Slot *>(static_cast<char *>(memory) +
+                                         sizeof(Queue));
+  for (std::size_t i = 0; i < count; i++) {
+    new (&slots[i]) Slot;
+  }
+
+  // Children inherit unflushed buffers and would write them out again.
+  std::cout.flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+
+  int live = 0;
+  for (int w = 0; w < workers && static_cast<std::size_t>(w) < count; w++) {
+    if (spawn_worker(queue, slots, count, run) > 0) {
+      live++;
+    }
+  }
+
+  int failed = 0;
+  std::size_t printed = 0;
+  while (printed < count) {
+    const std::uint32_t state =
+        slots[printed].state.load(std::memory_order_acquire);
+    if (state == DONE) {
+      const Slot &slot = slots[printed];
+      std::fwrite(slot.output, 1, slot.length, stdout);
+      std::fflush(stdout);
+      if (slot.truncated) {
+        std::cerr << "Job " << printed + 1 << ": output truncated to "
+                  << SLOT_OUTPUT << " bytes\n";
+      }
+      printed++;
+      continue;
+    }
+    if (state == FAILED) {
+      describe_failure(printed, slots[printed].wait_status);
+      failed++;
+      printed++;
+      continue;
+    }
+
+    int status = 0;
+    const pid_t pid = live > 0 ? waitpid(-1, &status, WNOHANG) : -1;
+    if (pid == 0) {
+      const timespec pause = {0, 1000000};
+      nanosleep(&pause, nullptr);
+      continue;
+    }
+    if (pid < 0 && live > 0 && errno == EINTR) {
+      continue;
+    }
+    if (pid > 0) {
+      live--;
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        continue;
+      }
+      for (std::size_t i = printed; i < count; i++) {
+        if (slots[i].state.load(std::memory_order_acquire) == RUNNING &&
+            slots[i].worker == pid) {
+          slots[i].wait_status = status;
+          slots[i].state.store(FAILED, std::memory_order_release);
+        }
+      }
+      if (queue->next.load() < count &&
+          spawn_worker(queue, slots, count, run) > 0) {
+        live++;
+      }
+      continue;
+    }
+    // Every worker is gone and this job never finished: it was claimed by
+    // a worker that died before recording itself, or no worker started.
+    slots[printed].wait_status = -1;
+    slots[printed].state.store(FAILED, std::memory_order_release);
+  }
+
+  while (live > 0 && waitpid(-1, nullptr, 0) > 0) {
+    live--;
+  }
+  munmap(memory, bytes);
+  return failed;
+}
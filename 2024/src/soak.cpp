@@ -0,0 +1,159 @@
+#include "soak.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Growth below this is allocator noise rather than a leak.
+constexpr long GROWTH_SLACK_BYTES = 64 << 10;
+// Latency drift between the halves of the steady state that gets flagged.
+constexpr double DRIFT_LIMIT = 0.20;
+// Steady-state samples needed before a rise on every step, or latency
+// drift, means more than chance.
+constexpr size_t MIN_TREND_SAMPLES = 8;
+
+struct Sample {
+  double ms;
+  long rss_bytes;
+  long heap_bytes; // -1 where the allocator cannot say
+};
+
+long resident_bytes() {
+  long pages = 0;
+  long resident = 0;
+  if (FILE *statm = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+      resident = 0;
+    }
+    std::fclose(statm);
+  }
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Bytes malloc has handed out and not had back; unlike RSS this drops as
+// soon as a solver frees, so it shows leaks the allocator would hide.
+long heap_in_use() {
+#ifdef __GLIBC__
+  const struct mallinfo2 info = mallinfo2();
+  return static_cast<long>(info.uordblks + info.hblkhd);
+#else
+  return -1;
+#endif
+}
+
+double median_ms(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t mid = values.size() / 2;
+  return values.size() % 2 ? values[mid]
+                           : (values[mid - 1] + values[mid]) / 2;
+}
+
+// Never shrinks from one iteration to the next, and either rises every
+// time (a leak per call, however small; only judged on MIN_TREND_SAMPLES or
+// more) or ends above where it started by more than the slack.
+bool grows(const std::vector<Sample> &steady, long Sample::*field) {
+  bool every_time = true;
+  for (size_t i = 1; i < steady.size(); i++) {
+    if (steady[i].*field < steady[i - 1].*field) {
+      return false;
+    }
+    every_time &= steady[i].*field > steady[i - 1].*field;
+  }
+  return (every_time && steady.size() >= MIN_TREND_SAMPLES) ||
+         steady.back().*field - steady.front().*field > GROWTH_SLACK_BYTES;
+}
+
+} // namespace
+
+bool run_soak(const std::string &label, int iterations,
+              const std::function<void()> &run) {
+  std::cout << "== Soak " << label << ": " << iterations << " iterations\n"
+            << std::left << std::setw(8) << "iter" << std::setw(12) << "ms"
+            << std::setw(14) << "rss KiB" << "heap KiB\n";
+
+  std::vector<Sample> samples;
+  samples.reserve(iterations);
+  for (int i = 0; i < iterations; i++) {
+    std::cout.flush();
+    std::fflush(stdout);
+    const int saved = dup(STDOUT_FILENO);
+    const int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+    close(devnull);
+
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout.flush();
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    const Sample sample = {
+        std::chrono::duration<double, std::milli>(end - start).count(),
+        resident_bytes(), heap_in_use()};
+    samples.push_back(sample);
+    std::cout << std::left << std::setw(8) << i + 1 << std::fixed
+              << std::setprecision(3) << std::setw(12) << sample.ms
+              << std::setw(14) << sample.rss_bytes / 1024;
+    if (sample.heap_bytes >= 0) {
+      std::cout << sample.heap_bytes / 1024;
+    } else {
+      std::cout << '-';
+    }
+    std::cout << '\n';
+  }
+
+  const size_t warmup = std::max<size_t>(1, samples.size() / 5);
+  if (samples.size() < warmup + 2) {
+    std::cout << "Too few iterations past warm-up to judge steady state\n";
+    return true;
+  }
+  const std::vector<Sample> steady(samples.begin() + warmup, samples.end());
+
+  bool ok = true;
+  if (steady.front().heap_bytes >= 0 && grows(steady, &Sample::heap_bytes)) {
+    std::cout << "LEAK: heap in use grew by "
+              << steady.back().heap_bytes - steady.front().heap_bytes
+              << " bytes after warm-up\n";
+    ok = false;
+  }
+  if (grows(steady, &Sample::rss_bytes)) {
+    std::cout << "GROWTH: RSS grew by "
+              << (steady.back().rss_bytes - steady.front().rss_bytes) / 1024
+              << " KiB after warm-up\n";
+    ok = false;
+  }
+
+  if (steady.size() < MIN_TREND_SAMPLES) {
+    std::cout << "Too few iterations past warm-up to judge per-call growth "
+                 "or drift\n";
+    return ok;
+  }
+
+  std::vector<double> first, second;
+  for (size_t i = 0; i < steady.size(); i++) {
+    (i < steady.size() / 2 ? first : second).push_back(steady[i].ms);
+  }
+  const double before = median_ms(first);
+  const double after = median_ms(second);
+  std::cout << std::fixed << std::setprecision(3) << "Steady-state median "
+            << before << " ms -> " << after << " ms\n";
+  if (after > before * (1 + DRIFT_LIMIT)) {
+    std::cout << "DRIFT: latency rose by "
+              << static_cast<int>((after / before - 1) * 100)
+              << "% across the steady state\n";
+    ok = false;
+  }
+  return ok;
+}
@@ -0,0 +1,49 @@
+#include "stats.h"
+#include <string.h>
+
+#define MAX_STATS 64
+
+typedef struct {
+  const char *name;
+  unsigned long long value;
+} Stat;
+
+static _Thread_local Stat stats[MAX_STATS];
+static _Thread_local int stat_count = 0;
+
+// Callers pass string literals, so the pointer usually matches first try.
+static unsigned long long *find_stat(const char *name) {
+  for (int i = 0; i < stat_count; i++) {
+    if (stats[i].name == name || strcmp(stats[i].name, name) == 0) {
+      return &stats[i].value;
+    }
+  }
+  if (stat_count == MAX_STATS) {
+    return NULL;
+  }
+  stats[stat_count].name = name;
+  stats[stat_count].value = 0;
+  return &stats[stat_count++].value;
+}
+
+void aoc_stat_add(const char *name, unsigned long long delta) {
+  unsigned long long *value = find_stat(name);
+  if (value) {
+    *value += delta;
+  }
+}
+
+void aoc_stat_max(const char *name, unsigned long long value) {
+  unsigned long long *current = find_stat(name);
+  if (current && value > *current) {
+    *current = value;
+  }
+}
+
+void aoc_stats_reset(void) { stat_count = 0; }
+
+void aoc_stats_print(FILE *out) {
+  for (int i = 0; i < stat_count; i++) {
+    fprintf(out, "%s %llu\n", stats[i].name, stats[i].value);
+  }
+}